@@ -1,621 +1,8050 @@
-#include <iostream>
-#include <ctime>
-#include <vector>
-#include <algorithm>
-#include <string>
-#include <iomanip>
-#include <memory>
-#include <random>
-
-using namespace std;
-
-class AlgorithmVisualizer {
-private:
-    vector<int> originalArray;
-    vector<int> currentArray;
-    vector<double> algorithmTimes;
-    
-    // Algorithm names for display
-    const vector<string> algorithmNames = {
-        "Linear Search", "Binary Search", "Bubble Sort", 
-        "Merge Sort", "Quick Sort", "Selection Sort", "Insertion Sort"
-    };
-
-public:
-    AlgorithmVisualizer() = default;
-    
-    void setArray(const vector<int>& arr) {
-        originalArray = arr;
-        currentArray = arr;
-    }
-    
-    void resetArray() {
-        currentArray = originalArray;
-    }
-    
-    void displayArray(const vector<int>& arr, const string& label = "") const {
-        if (!label.empty()) {
-            cout << label << ": ";
-        }
-        cout << "[";
-        for (size_t i = 0; i < arr.size(); ++i) {
-            cout << arr[i];
-            if (i < arr.size() - 1) cout << ", ";
-        }
-        cout << "]" << endl;
-    }
-    
-    void displayArrayWithHighlight(const vector<int>& arr, int highlightIndex = -1, const string& label = "") const {
-        if (!label.empty()) {
-            cout << label << ": ";
-        }
-        cout << "[";
-        for (size_t i = 0; i < arr.size(); ++i) {
-            if (static_cast<int>(i) == highlightIndex) {
-                cout << ">" << arr[i] << "<";
-            } else {
-                cout << arr[i];
-            }
-            if (i < arr.size() - 1) cout << ", ";
-        }
-        cout << "]" << endl;
-    }
-    
-    void delay(int ms) const {
-        clock_t start_time = clock();
-        while (clock() < start_time + ms * (CLOCKS_PER_SEC / 1000));
-    }
-    
-    // Enhanced Linear Search with step-by-step visualization
-    int linearSearch(int target, bool verbose = true) {
-        resetArray();
-        if (verbose) {
-            cout << "\n--- Linear Search Process ---" << endl;
-            cout << "Searching for: " << target << endl;
-        }
-        
-        clock_t start = clock();
-        
-        for (size_t i = 0; i < currentArray.size(); ++i) {
-            if (verbose) {
-                displayArrayWithHighlight(currentArray, i, "Step " + to_string(i + 1));
-                delay(500);
-            }
-            
-            if (currentArray[i] == target) {
-                clock_t end = clock();
-                double timeTaken = double(end - start) / CLOCKS_PER_SEC;
-                algorithmTimes[0] = timeTaken;
-                
-                if (verbose) {
-                    cout << "✓ Found at index: " << i << endl;
-                    cout << "Time taken: " << fixed << setprecision(6) << timeTaken << " seconds" << endl;
-                }
-                return i;
-            }
-        }
-        
-        clock_t end = clock();
-        double timeTaken = double(end - start) / CLOCKS_PER_SEC;
-        algorithmTimes[0] = timeTaken;
-        
-        if (verbose) {
-            cout << "✗ Element not found" << endl;
-            cout << "Time taken: " << fixed << setprecision(6) << timeTaken << " seconds" << endl;
-        }
-        return -1;
-    }
-    
-    // Enhanced Binary Search
-    int binarySearch(int target, bool verbose = true) {
-        resetArray();
-        vector<int> sortedArray = currentArray;
-        sort(sortedArray.begin(), sortedArray.end());
-        
-        if (verbose) {
-            cout << "\n--- Binary Search Process ---" << endl;
-            cout << "Searching for: " << target << endl;
-            cout << "Sorted array: ";
-            displayArray(sortedArray);
-        }
-        
-        clock_t start = clock();
-        int left = 0, right = sortedArray.size() - 1;
-        int step = 1;
-        
-        while (left <= right) {
-            int mid = left + (right - left) / 2;
-            
-            if (verbose) {
-                cout << "\nStep " << step++ << ":" << endl;
-                cout << "Search range: indices " << left << " to " << right << endl;
-                cout << "Middle index: " << mid << " → Value: " << sortedArray[mid] << endl;
-                delay(500);
-            }
-            
-            if (sortedArray[mid] == target) {
-                clock_t end = clock();
-                double timeTaken = double(end - start) / CLOCKS_PER_SEC;
-                algorithmTimes[1] = timeTaken;
-                
-                if (verbose) {
-                    cout << "✓ Found at index: " << mid << endl;
-                    cout << "Time taken: " << fixed << setprecision(6) << timeTaken << " seconds" << endl;
-                }
-                return mid;
-            }
-            else if (sortedArray[mid] < target) {
-                left = mid + 1;
-            }
-            else {
-                right = mid - 1;
-            }
-        }
-        
-        clock_t end = clock();
-        double timeTaken = double(end - start) / CLOCKS_PER_SEC;
-        algorithmTimes[1] = timeTaken;
-        
-        if (verbose) {
-            cout << "✗ Element not found" << endl;
-            cout << "Time taken: " << fixed << setprecision(6) << timeTaken << " seconds" << endl;
-        }
-        return -1;
-    }
-    
-    // Enhanced Bubble Sort with optimization
-    void bubbleSort(bool verbose = true) {
-        resetArray();
-        if (verbose) {
-            cout << "\n--- Bubble Sort Process ---" << endl;
-            displayArray(currentArray, "Original array");
-        }
-        
-        clock_t start = clock();
-        bool swapped;
-        int pass = 1;
-        
-        for (size_t i = 0; i < currentArray.size() - 1; ++i) {
-            swapped = false;
-            
-            if (verbose) {
-                cout << "\n--- Pass " << pass++ << " ---" << endl;
-            }
-            
-            for (size_t j = 0; j < currentArray.size() - i - 1; ++j) {
-                if (currentArray[j] > currentArray[j + 1]) {
-                    swap(currentArray[j], currentArray[j + 1]);
-                    swapped = true;
-                    
-                    if (verbose) {
-                        displayArrayWithHighlight(currentArray, j, "Swapped " + to_string(j) + " and " + to_string(j + 1));
-                        delay(300);
-                    }
-                }
-            }
-            
-            if (!swapped) break; // Optimization: stop if no swaps occurred
-        }
-        
-        clock_t end = clock();
-        double timeTaken = double(end - start) / CLOCKS_PER_SEC;
-        algorithmTimes[2] = timeTaken;
-        
-        if (verbose) {
-            cout << "\n✓ Sorting completed!" << endl;
-            displayArray(currentArray, "Sorted array");
-            cout << "Time taken: " << fixed << setprecision(6) << timeTaken << " seconds" << endl;
-        }
-    }
-    
-    // Enhanced Selection Sort
-    void selectionSort(bool verbose = true) {
-        resetArray();
-        if (verbose) {
-            cout << "\n--- Selection Sort Process ---" << endl;
-            displayArray(currentArray, "Original array");
-        }
-        
-        clock_t start = clock();
-        
-        for (size_t i = 0; i < currentArray.size() - 1; ++i) {
-            size_t minIdx = i;
-            
-            if (verbose) {
-                cout << "\n--- Iteration " << i + 1 << " ---" << endl;
-                cout << "Finding minimum from index " << i << " to " << currentArray.size() - 1 << endl;
-            }
-            
-            for (size_t j = i + 1; j < currentArray.size(); ++j) {
-                if (currentArray[j] < currentArray[minIdx]) {
-                    minIdx = j;
-                }
-            }
-            
-            if (minIdx != i) {
-                swap(currentArray[i], currentArray[minIdx]);
-                
-                if (verbose) {
-                    cout << "Minimum found at index " << minIdx << " → " << currentArray[i] << endl;
-                    displayArrayWithHighlight(currentArray, i, "Placed minimum at position " + to_string(i));
-                    delay(300);
-                }
-            }
-        }
-        
-        clock_t end = clock();
-        double timeTaken = double(end - start) / CLOCKS_PER_SEC;
-        algorithmTimes[5] = timeTaken;
-        
-        if (verbose) {
-            cout << "\n✓ Sorting completed!" << endl;
-            displayArray(currentArray, "Sorted array");
-            cout << "Time taken: " << fixed << setprecision(6) << timeTaken << " seconds" << endl;
-        }
-    }
-    
-    // Enhanced Insertion Sort
-    void insertionSort(bool verbose = true) {
-        resetArray();
-        if (verbose) {
-            cout << "\n--- Insertion Sort Process ---" << endl;
-            displayArray(currentArray, "Original array");
-        }
-        
-        clock_t start = clock();
-        
-        for (size_t i = 1; i < currentArray.size(); ++i) {
-            int key = currentArray[i];
-            int j = i - 1;
-            
-            if (verbose) {
-                cout << "\nInserting element " << key << " at position " << i << endl;
-            }
-            
-            while (j >= 0 && currentArray[j] > key) {
-                currentArray[j + 1] = currentArray[j];
-                --j;
-                
-                if (verbose) {
-                    displayArrayWithHighlight(currentArray, j + 1, "Shifting");
-                    delay(300);
-                }
-            }
-            currentArray[j + 1] = key;
-            
-            if (verbose) {
-                displayArrayWithHighlight(currentArray, j + 1, "Inserted " + to_string(key));
-                delay(300);
-            }
-        }
-        
-        clock_t end = clock();
-        double timeTaken = double(end - start) / CLOCKS_PER_SEC;
-        algorithmTimes[6] = timeTaken;
-        
-        if (verbose) {
-            cout << "\n✓ Sorting completed!" << endl;
-            displayArray(currentArray, "Sorted array");
-            cout << "Time taken: " << fixed << setprecision(6) << timeTaken << " seconds" << endl;
-        }
-    }
-    
-    // Quick Sort implementation
-    void quickSort(bool verbose = true) {
-        resetArray();
-        if (verbose) {
-            cout << "\n--- Quick Sort Process ---" << endl;
-            displayArray(currentArray, "Original array");
-        }
-        
-        clock_t start = clock();
-        quickSortHelper(0, currentArray.size() - 1, verbose);
-        clock_t end = clock();
-        
-        double timeTaken = double(end - start) / CLOCKS_PER_SEC;
-        algorithmTimes[4] = timeTaken;
-        
-        if (verbose) {
-            cout << "\n✓ Sorting completed!" << endl;
-            displayArray(currentArray, "Sorted array");
-            cout << "Time taken: " << fixed << setprecision(6) << timeTaken << " seconds" << endl;
-        }
-    }
-    
-private:
-    void quickSortHelper(int low, int high, bool verbose) {
-        if (low < high) {
-            int pi = partition(low, high, verbose);
-            quickSortHelper(low, pi - 1, verbose);
-            quickSortHelper(pi + 1, high, verbose);
-        }
-    }
-    
-    int partition(int low, int high, bool verbose) {
-        int pivot = currentArray[high];
-        int i = low - 1;
-        
-        if (verbose) {
-            cout << "\nPartitioning from " << low << " to " << high << " with pivot " << pivot << endl;
-        }
-        
-        for (int j = low; j < high; ++j) {
-            if (currentArray[j] < pivot) {
-                ++i;
-                swap(currentArray[i], currentArray[j]);
-                
-                if (verbose) {
-                    displayArrayWithHighlight(currentArray, i, "Swapped");
-                    delay(200);
-                }
-            }
-        }
-        swap(currentArray[i + 1], currentArray[high]);
-        
-        if (verbose) {
-            displayArrayWithHighlight(currentArray, i + 1, "Final pivot position");
-            delay(200);
-        }
-        
-        return i + 1;
-    }
-    
-public:
-    // Merge Sort implementation
-    void mergeSort(bool verbose = true) {
-        resetArray();
-        if (verbose) {
-            cout << "\n--- Merge Sort Process ---" << endl;
-            displayArray(currentArray, "Original array");
-        }
-        
-        clock_t start = clock();
-        mergeSortHelper(0, currentArray.size() - 1, verbose);
-        clock_t end = clock();
-        
-        double timeTaken = double(end - start) / CLOCKS_PER_SEC;
-        algorithmTimes[3] = timeTaken;
-        
-        if (verbose) {
-            cout << "\n✓ Sorting completed!" << endl;
-            displayArray(currentArray, "Sorted array");
-            cout << "Time taken: " << fixed << setprecision(6) << timeTaken << " seconds" << endl;
-        }
-    }
-    
-private:
-    void mergeSortHelper(int left, int right, bool verbose) {
-        if (left < right) {
-            int mid = left + (right - left) / 2;
-            
-            if (verbose) {
-                cout << "\nDividing: [" << left << " - " << mid << "] and [" << (mid + 1) << " - " << right << "]" << endl;
-            }
-            
-            mergeSortHelper(left, mid, verbose);
-            mergeSortHelper(mid + 1, right, verbose);
-            merge(left, mid, right, verbose);
-        }
-    }
-    
-    void merge(int left, int mid, int right, bool verbose) {
-        if (verbose) {
-            cout << "Merging: [" << left << " - " << mid << "] and [" << (mid + 1) << " - " << right << "]" << endl;
-        }
-        
-        int n1 = mid - left + 1;
-        int n2 = right - mid;
-        
-        vector<int> L(n1), R(n2);
-        
-        for (int i = 0; i < n1; ++i) L[i] = currentArray[left + i];
-        for (int j = 0; j < n2; ++j) R[j] = currentArray[mid + 1 + j];
-        
-        int i = 0, j = 0, k = left;
-        
-        while (i < n1 && j < n2) {
-            if (L[i] <= R[j]) {
-                currentArray[k++] = L[i++];
-            } else {
-                currentArray[k++] = R[j++];
-            }
-        }
-        
-        while (i < n1) currentArray[k++] = L[i++];
-        while (j < n2) currentArray[k++] = R[j++];
-        
-        if (verbose) {
-            displayArrayWithHighlight(currentArray, -1, "After merge");
-            delay(300);
-        }
-    }
-    
-public:
-    // Performance comparison feature
-    void compareAlgorithms() {
-        cout << "\n=== ALGORITHM PERFORMANCE COMPARISON ===" << endl;
-        displayArray(originalArray, "Test Array");
-        cout << endl;
-        
-        // Initialize times
-        algorithmTimes.resize(7, 0.0);
-        
-        // Test each algorithm
-        linearSearch(originalArray[0], false);
-        binarySearch(originalArray[0], false);
-        bubbleSort(false);
-        mergeSort(false);
-        quickSort(false);
-        selectionSort(false);
-        insertionSort(false);
-        
-        // Display results
-        cout << "┌──────────────────────┬──────────────────┐" << endl;
-        cout << "│     Algorithm        │    Time (sec)    │" << endl;
-        cout << "├──────────────────────┼──────────────────┤" << endl;
-        
-        double minTime = *min_element(algorithmTimes.begin(), algorithmTimes.end());
-        
-        for (size_t i = 0; i < algorithmNames.size(); ++i) {
-            cout << "│ " << setw(20) << left << algorithmNames[i] << " │ " 
-                 << setw(12) << right << fixed << setprecision(6) << algorithmTimes[i];
-            if (algorithmTimes[i] == minTime) {
-                cout << " ⭐ │" << endl;
-            } else {
-                cout << "   │" << endl;
-            }
-        }
-        cout << "└──────────────────────┴──────────────────┘" << endl;
-        
-        // Find fastest algorithm
-        auto minIt = min_element(algorithmTimes.begin(), algorithmTimes.end());
-        int fastestIndex = distance(algorithmTimes.begin(), minIt);
-        
-        cout << "\n🏆 Fastest Algorithm: " << algorithmNames[fastestIndex] 
-             << " (" << fixed << setprecision(6) << *minIt << " seconds)" << endl;
-    }
-    
-    // Generate random array
-    vector<int> generateRandomArray(int size, int minVal = 1, int maxVal = 100) {
-        random_device rd;
-        mt19937 gen(rd());
-        uniform_int_distribution<> dis(minVal, maxVal);
-        
-        vector<int> randomArray(size);
-        for (int i = 0; i < size; ++i) {
-            randomArray[i] = dis(gen);
-        }
-        return randomArray;
-    }
-};
-
-class MenuSystem {
-private:
-    AlgorithmVisualizer visualizer;
-    
-public:
-    void displayMainMenu() {
-        cout << "\n==========================================" << endl;
-        cout << "      ALGORITHM VISUALIZER & ANALYZER" << endl;
-        cout << "==========================================" << endl;
-        cout << "1. Linear Search" << endl;
-        cout << "2. Binary Search" << endl;
-        cout << "3. Bubble Sort" << endl;
-        cout << "4. Merge Sort" << endl;
-        cout << "5. Quick Sort" << endl;
-        cout << "6. Selection Sort" << endl;
-        cout << "7. Insertion Sort" << endl;
-        cout << "8. Compare All Algorithms" << endl;
-        cout << "9. Generate Random Array" << endl;
-        cout << "0. Exit" << endl;
-        cout << "==========================================" << endl;
-        cout << "Enter your choice (0-9): ";
-    }
-    
-    void run() {
-        vector<int> currentArray;
-        int choice;
-        
-        do {
-            displayMainMenu();
-            cin >> choice;
-            
-            if (choice >= 1 && choice <= 8 && currentArray.empty()) {
-                cout << "No array data! Please generate or enter an array first (option 9)." << endl;
-                continue;
-            }
-            
-            switch (choice) {
-                case 1: {
-                    int target;
-                    cout << "Enter target value to search: ";
-                    cin >> target;
-                    visualizer.linearSearch(target);
-                    break;
-                }
-                case 2: {
-                    int target;
-                    cout << "Enter target value to search: ";
-                    cin >> target;
-                    visualizer.binarySearch(target);
-                    break;
-                }
-                case 3:
-                    visualizer.bubbleSort();
-                    break;
-                case 4:
-                    visualizer.mergeSort();
-                    break;
-                case 5:
-                    visualizer.quickSort();
-                    break;
-                case 6:
-                    visualizer.selectionSort();
-                    break;
-                case 7:
-                    visualizer.insertionSort();
-                    break;
-                case 8:
-                    visualizer.compareAlgorithms();
-                    break;
-                case 9:
-                    handleArrayInput();
-                    break;
-                case 0:
-                    cout << "Thank you for using Algorithm Visualizer!" << endl;
-                    break;
-                default:
-                    cout << "Invalid choice! Please try again." << endl;
-            }
-            
-            if (choice != 0) {
-                cout << "\nPress Enter to continue...";
-                cin.ignore();
-                cin.get();
-            }
-            
-        } while (choice != 0);
-    }
-    
-private:
-    void handleArrayInput() {
-        cout << "\n=== ARRAY INPUT OPTIONS ===" << endl;
-        cout << "1. Generate random array" << endl;
-        cout << "2. Enter array manually" << endl;
-        cout << "Choose option: ";
-        
-        int option;
-        cin >> option;
-        
-        vector<int> array;
-        
-        if (option == 1) {
-            int size;
-            cout << "Enter array size: ";
-            cin >> size;
-            array = visualizer.generateRandomArray(size);
-        } else if (option == 2) {
-            int size;
-            cout << "Enter array size: ";
-            cin >> size;
-            cout << "Enter " << size << " elements separated by spaces: ";
-            array.resize(size);
-            for (int i = 0; i < size; ++i) {
-                cin >> array[i];
-            }
-        } else {
-            cout << "Invalid option!" << endl;
-            return;
-        }
-        
-        visualizer.setArray(array);
-        cout << "Array set successfully: ";
-        visualizer.displayArray(array);
-    }
-};
-
-int main() {
-    MenuSystem menu;
-    menu.run();
-    return 0;
+#include <iostream>
+#include <ctime>
+#include <vector>
+#include <algorithm>
+#include <string>
+#include <iomanip>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <fstream>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <cstring>
+#include <cstdint>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <future>
+#include <exception>
+#include <cstdio>
+#include <type_traits>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define ANALYZER_X86_SIMD 1
+#if defined(__GNUC__) && !defined(__clang__)
+// GCC's _mm512_undefined_* helpers trip its own uninitialized-use warnings
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#include <immintrin.h>
+#pragma GCC diagnostic pop
+#else
+#include <immintrin.h>
+#endif
+#endif
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sched.h>
+#include <pthread.h>
+#endif
+
+using namespace std;
+
+// Summary of repeated timed runs of a single algorithm
+struct BenchmarkStats {
+    vector<double> samples;     // measured seconds per run, in execution order
+    double minTime = 0.0;
+    double median = 0.0;
+    double p95 = 0.0;
+    double mean = 0.0;
+    double stddev = 0.0;
+    int warmupRuns = 0;
+    bool timedOut = false;      // the time limit stopped the runs early
+    vector<double> counters;    // median hardware counter values per run, empty when not collected
+};
+
+// Controls how long the benchmark engine keeps repeating a measurement
+struct BenchmarkConfig {
+    int warmupRuns = 2;
+    int minRuns = 5;
+    int maxRuns = 10000;
+    double timeBudget = 0.25;           // wall-clock seconds per algorithm
+    double targetRelativeError = 0.01;  // 95% CI half-width relative to the mean
+    double timeLimit = 0.0;             // hard stop in seconds, warm-ups included, even below minRuns; 0 = none
+};
+
+class BenchmarkEngine {
+private:
+    BenchmarkConfig config;
+
+public:
+    explicit BenchmarkEngine(const BenchmarkConfig& cfg = BenchmarkConfig()) : config(cfg) {}
+
+    const BenchmarkConfig& getConfig() const { return config; }
+    void setConfig(const BenchmarkConfig& cfg) { config = cfg; }
+
+    // runOnce performs one full run and returns the seconds spent in its timed region
+    BenchmarkStats run(const function<double()>& runOnce) const {
+        chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+        auto overLimit = [&]() {
+            return config.timeLimit > 0.0 &&
+                   chrono::duration<double>(chrono::steady_clock::now() - begin).count() >= config.timeLimit;
+        };
+        
+        int warmups = 0;
+        while (warmups < config.warmupRuns && !overLimit()) {
+            runOnce();
+            ++warmups;
+        }
+
+        vector<double> samples;
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        bool timedOut = false;
+
+        while (static_cast<int>(samples.size()) < config.maxRuns) {
+            samples.push_back(runOnce());
+
+            // One sample is always kept, even when the warm-ups used up the limit
+            if (overLimit()) {
+                timedOut = static_cast<int>(samples.size()) < config.minRuns;
+                break;
+            }
+            if (static_cast<int>(samples.size()) < config.minRuns) continue;
+
+            double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            if (elapsed >= config.timeBudget) break;
+            if (relativeError(samples) <= config.targetRelativeError) break;
+        }
+
+        BenchmarkStats stats = summarize(samples);
+        stats.warmupRuns = warmups;
+        stats.timedOut = timedOut || warmups < config.warmupRuns;
+        return stats;
+    }
+
+    static BenchmarkStats summarize(const vector<double>& samples) {
+        BenchmarkStats stats;
+        stats.samples = samples;
+        if (samples.empty()) return stats;
+
+        vector<double> sorted = samples;
+        sort(sorted.begin(), sorted.end());
+
+        stats.minTime = sorted.front();
+        stats.median = percentile(sorted, 0.50);
+        stats.p95 = percentile(sorted, 0.95);
+
+        double sum = 0.0;
+        for (double s : sorted) sum += s;
+        stats.mean = sum / sorted.size();
+
+        double sq = 0.0;
+        for (double s : sorted) sq += (s - stats.mean) * (s - stats.mean);
+        stats.stddev = sorted.size() > 1 ? sqrt(sq / (sorted.size() - 1)) : 0.0;
+        return stats;
+    }
+
+    // Linear interpolation between closest ranks; expects sorted input
+    static double percentile(const vector<double>& sorted, double p) {
+        if (sorted.empty()) return 0.0;
+        double rank = p * (sorted.size() - 1);
+        size_t lo = static_cast<size_t>(floor(rank));
+        size_t hi = static_cast<size_t>(ceil(rank));
+        double frac = rank - lo;
+        return sorted[lo] + (sorted[hi] - sorted[lo]) * frac;
+    }
+
+private:
+    static double relativeError(const vector<double>& samples) {
+        if (samples.size() < 2) return 0.0;
+        double sum = 0.0;
+        for (double s : samples) sum += s;
+        double mean = sum / samples.size();
+        if (mean <= 0.0) return 0.0;
+
+        double sq = 0.0;
+        for (double s : samples) sq += (s - mean) * (s - mean);
+        double stddev = sqrt(sq / (samples.size() - 1));
+        return 1.96 * stddev / sqrt(static_cast<double>(samples.size())) / mean;
+    }
+};
+
+// Formats a duration in seconds with a readable unit (ns, us, ms, s)
+string formatDuration(double seconds) {
+    ostringstream out;
+    out << fixed << setprecision(3);
+    if (seconds < 1e-6) {
+        out << seconds * 1e9 << " ns";
+    } else if (seconds < 1e-3) {
+        out << seconds * 1e6 << " us";
+    } else if (seconds < 1.0) {
+        out << seconds * 1e3 << " ms";
+    } else {
+        out << seconds << " s";
+    }
+    return out.str();
+}
+
+// Formats a byte count with a binary unit (B, KB, MB, GB)
+string formatBytes(double bytes) {
+    const char* units[] = {"B", "KB", "MB", "GB", "TB"};
+    int unit = 0;
+    while (bytes >= 1024.0 && unit < 4) {
+        bytes /= 1024.0;
+        ++unit;
+    }
+    ostringstream out;
+    out << setprecision(bytes == floor(bytes) ? 0 : 1) << fixed << bytes << " " << units[unit];
+    return out.str();
+}
+
+// Per-run hardware event counts read through Linux perf_event_open.
+// Events the kernel or CPU cannot provide are reported as unavailable (NaN).
+class PerfCounters {
+private:
+    struct Event {
+        string name;
+        uint32_t type;
+        uint64_t config;
+    };
+    
+    vector<Event> events;
+    vector<int> fds;
+    vector<double> values;
+    
+public:
+    PerfCounters() {
+#ifdef __linux__
+        const uint64_t l1dReadMiss = PERF_COUNT_HW_CACHE_L1D
+            | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        events = {
+            {"Cycles",       PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+            {"Instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {"Branch Miss",  PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+            {"L1D Miss",     PERF_TYPE_HW_CACHE, l1dReadMiss},
+            {"LLC Miss",     PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+            {"Page Faults",  PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS}
+        };
+#endif
+        fds.assign(events.size(), -1);
+        values.assign(events.size(), numeric_limits<double>::quiet_NaN());
+    }
+    
+    ~PerfCounters() {
+        close();
+    }
+    
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+    
+    // Opens every event for the calling thread; returns true if at least one is usable
+    bool open() {
+        close();
+#ifdef __linux__
+        for (size_t i = 0; i < events.size(); ++i) {
+            perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = events[i].type;
+            attr.config = events[i].config;
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            fds[i] = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+        }
+#endif
+        return available();
+    }
+    
+    void close() {
+#ifdef __linux__
+        for (int& fd : fds) {
+            if (fd >= 0) ::close(fd);
+            fd = -1;
+        }
+#endif
+    }
+    
+    bool available() const {
+        for (int fd : fds) {
+            if (fd >= 0) return true;
+        }
+        return false;
+    }
+    
+    void start() {
+#ifdef __linux__
+        for (int fd : fds) {
+            if (fd < 0) continue;
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+    
+    void stop() {
+#ifdef __linux__
+        for (int fd : fds) {
+            if (fd >= 0) ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        }
+        for (size_t i = 0; i < fds.size(); ++i) {
+            values[i] = numeric_limits<double>::quiet_NaN();
+            uint64_t data[3];
+            if (fds[i] < 0 || ::read(fds[i], data, sizeof(data)) != sizeof(data)) continue;
+            
+            // Scale up when the kernel multiplexed the counter for part of the run
+            if (data[2] > 0) {
+                values[i] = static_cast<double>(data[0]) * data[1] / data[2];
+            } else if (data[1] == 0) {
+                values[i] = static_cast<double>(data[0]);
+            }
+        }
+#endif
+    }
+    
+    size_t eventCount() const { return events.size(); }
+    const string& eventName(size_t i) const { return events[i].name; }
+    
+    // Values from the most recent start/stop pair
+    const vector<double>& lastValues() const { return values; }
+};
+
+// Element-level operation tallies for one algorithm run
+struct OperationCounts {
+    uint64_t comparisons = 0;
+    uint64_t swaps = 0;
+    uint64_t writes = 0;            // element stores other than swaps, including scratch buffers
+    uint64_t allocations = 0;
+    uint64_t allocatedBytes = 0;
+    
+    OperationCounts& operator+=(const OperationCounts& other) {
+        comparisons += other.comparisons;
+        swaps += other.swaps;
+        writes += other.writes;
+        allocations += other.allocations;
+        allocatedBytes += other.allocatedBytes;
+        return *this;
+    }
+};
+
+// Progress markers an observer can use to narrate what an algorithm is doing
+enum class StepKind {
+    Visit,          // linear scan reached index a
+    Probe,          // binary search probes mid c within [a, b]
+    Pass,           // start of pass number a
+    Scan,           // selection scan over [a, b]
+    Insert,         // insertion of the element at index a
+    Partition,      // partitioning [a, b] around the element at b
+    PivotPlaced,    // pivot settled at index a
+    Divide,         // split of [a, b] at c
+    Merge,          // merge of [a, c] with [c + 1, b] begins
+    Merged,         // merge of [a, b] finished
+    Digit,          // distribution pass number a on key bits [b, c]
+    Bucket          // in-place distribution of [a, b] on the key bits from c up
+};
+
+// Operation policies passed to the algorithms. Positions are offsets from the
+// range start. vectorStep reports a whole SIMD kernel call or sorting network at once,
+// counting each lane compared by a comparator as one comparison. NullOps compiles to nothing,
+// so uncounted runs pay no cost; CountingOps tallies silently.
+struct NullOps {
+    void compare(size_t, size_t) {}
+    void swap(size_t, size_t) {}
+    void write(size_t) {}
+    void bufferWrite(uint64_t) {}
+    void vectorStep(uint64_t, uint64_t) {}
+    void allocate(uint64_t) {}
+    void step(StepKind, size_t, size_t, size_t = 0) {}
+};
+
+struct CountingOps {
+    OperationCounts counts;
+    
+    void compare(size_t, size_t) { ++counts.comparisons; }
+    void swap(size_t, size_t) { ++counts.swaps; }
+    void write(size_t) { ++counts.writes; }
+    void bufferWrite(uint64_t n) { counts.writes += n; }
+    void vectorStep(uint64_t comparisons, uint64_t writes) {
+        counts.comparisons += comparisons;
+        counts.writes += writes;
+    }
+    void allocate(uint64_t bytes) {
+        ++counts.allocations;
+        counts.allocatedBytes += bytes;
+    }
+    void step(StepKind, size_t, size_t, size_t = 0) {}
+};
+
+// Fork-join thread pool: every worker owns a deque, pops its newest task and
+// steals the oldest task of another worker when its own deque runs dry. The
+// thread waiting on a TaskGroup takes part as the last worker.
+class WorkStealingPool {
+private:
+    struct WorkQueue {
+        mutex lock;
+        deque<function<void()>> tasks;
+    };
+    
+    vector<unique_ptr<WorkQueue>> queues;
+    vector<thread> workers;
+    atomic<size_t> queued;
+    atomic<bool> stopping;
+    mutex sleepLock;
+    condition_variable wake;
+    
+    static thread_local WorkStealingPool* currentPool;
+    static thread_local size_t currentIndex;
+    
+public:
+    explicit WorkStealingPool(size_t threadCount) : queued(0), stopping(false) {
+        threadCount = max<size_t>(1, threadCount);
+        for (size_t i = 0; i < threadCount; ++i) {
+            queues.push_back(unique_ptr<WorkQueue>(new WorkQueue));
+        }
+        for (size_t i = 0; i + 1 < threadCount; ++i) {
+            workers.push_back(thread(&WorkStealingPool::workerLoop, this, i));
+        }
+    }
+    
+    ~WorkStealingPool() {
+        {
+            lock_guard<mutex> guard(sleepLock);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (thread& worker : workers) worker.join();
+    }
+    
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+    
+    size_t size() const { return queues.size(); }
+    
+    void submit(function<void()> task) {
+        WorkQueue& queue = *queues[ownQueue()];
+        {
+            lock_guard<mutex> guard(queue.lock);
+            queue.tasks.push_back(std::move(task));
+        }
+        ++queued;
+        {
+            lock_guard<mutex> guard(sleepLock);
+        }
+        wake.notify_one();
+    }
+    
+    // Runs one queued task, preferring the caller's own deque; returns false if none was found
+    bool runPendingTask() {
+        size_t self = ownQueue();
+        function<void()> task;
+        
+        if (!popNewest(self, task)) {
+            bool stolen = false;
+            for (size_t k = 1; k < queues.size() && !stolen; ++k) {
+                stolen = stealOldest((self + k) % queues.size(), task);
+            }
+            if (!stolen) return false;
+        }
+        
+        --queued;
+        task();
+        return true;
+    }
+    
+private:
+    size_t ownQueue() const {
+        return currentPool == this ? currentIndex : queues.size() - 1;
+    }
+    
+    bool popNewest(size_t index, function<void()>& task) {
+        WorkQueue& queue = *queues[index];
+        lock_guard<mutex> guard(queue.lock);
+        if (queue.tasks.empty()) return false;
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+        return true;
+    }
+    
+    bool stealOldest(size_t index, function<void()>& task) {
+        WorkQueue& queue = *queues[index];
+        lock_guard<mutex> guard(queue.lock);
+        if (queue.tasks.empty()) return false;
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        return true;
+    }
+    
+    void workerLoop(size_t index) {
+        currentPool = this;
+        currentIndex = index;
+        
+        while (true) {
+            if (runPendingTask()) continue;
+            
+            unique_lock<mutex> lock(sleepLock);
+            wake.wait(lock, [this]() { return stopping || queued > 0; });
+            if (stopping && queued == 0) return;
+        }
+    }
+};
+
+thread_local WorkStealingPool* WorkStealingPool::currentPool = nullptr;
+thread_local size_t WorkStealingPool::currentIndex = 0;
+
+// Tracks tasks forked from one scope; wait() keeps executing pool tasks until they finish
+// and rethrows the first exception a task threw
+class TaskGroup {
+private:
+    WorkStealingPool& pool;
+    atomic<size_t> pending;
+    mutex failureLock;
+    exception_ptr failure;
+    
+    void drain() {
+        while (pending > 0) {
+            if (!pool.runPendingTask()) this_thread::yield();
+        }
+    }
+    
+public:
+    explicit TaskGroup(WorkStealingPool& p) : pool(p), pending(0) {}
+    
+    // Destructors must not throw: an unwaited failure is dropped
+    ~TaskGroup() {
+        drain();
+    }
+    
+    void run(function<void()> task) {
+        ++pending;
+        pool.submit([this, task]() {
+            try {
+                task();
+            } catch (...) {
+                lock_guard<mutex> guard(failureLock);
+                if (!failure) failure = current_exception();
+            }
+            --pending;
+        });
+    }
+    
+    void wait() {
+        drain();
+        exception_ptr thrown;
+        {
+            lock_guard<mutex> guard(failureLock);
+            swap(thrown, failure);
+        }
+        if (thrown) rethrow_exception(thrown);
+    }
+};
+
+// Integer sorting kernels for the vectorized sorts. Every instruction set provides the
+// same three kernels; kernelsFor() hands out the widest set the CPU supports at runtime.
+namespace simd {
+
+enum class Level { Scalar, Avx2, Avx512 };
+
+struct SortKernels {
+    Level level;
+    const char* name;
+    size_t blockSize;       // largest range sortBlock handles
+    
+    // Sorts data[0, n) for n <= blockSize; returns the comparators evaluated
+    uint64_t (*sortBlock)(int* data, size_t n);
+    // Moves the elements below pivot to the front, in any order; returns their count
+    size_t (*partition)(int* data, size_t n, int pivot);
+    // Merges sorted a and b into out; returns the comparators evaluated
+    uint64_t (*merge)(const int* a, size_t na, const int* b, size_t nb, int* out);
+};
+
+inline uint64_t scalarSortBlock(int* data, size_t n) {
+    uint64_t comparisons = 0;
+    for (size_t i = 1; i < n; ++i) {
+        int key = data[i];
+        size_t j = i;
+        while (j > 0 && (++comparisons, key < data[j - 1])) {
+            data[j] = data[j - 1];
+            --j;
+        }
+        data[j] = key;
+    }
+    return comparisons;
+}
+
+// Branchless Lomuto: every element is swapped, the store index advances only for keepers
+inline size_t scalarPartition(int* data, size_t n, int pivot) {
+    size_t store = 0;
+    for (size_t i = 0; i < n; ++i) {
+        int value = data[i];
+        data[i] = data[store];
+        data[store] = value;
+        store += value < pivot;
+    }
+    return store;
+}
+
+inline uint64_t scalarMerge(const int* a, size_t na, const int* b, size_t nb, int* out) {
+    size_t i = 0, j = 0;
+    uint64_t comparisons = 0;
+    while (i < na && j < nb) {
+        ++comparisons;
+        *out++ = b[j] < a[i] ? b[j++] : a[i++];
+    }
+    while (i < na) *out++ = a[i++];
+    while (j < nb) *out++ = b[j++];
+    return comparisons;
+}
+
+// Merges the sorted block held in tail with the rests of a and b straight into out: three
+// ways while all of them have keys left, two ways once one runs dry
+inline uint64_t scalarMergeTail(const int* tail, size_t nt, const int* a, size_t na,
+                                const int* b, size_t nb, int* out) {
+    uint64_t comparisons = 0;
+    size_t t = 0, i = 0, j = 0;
+    while (t < nt && i < na && j < nb) {
+        comparisons += 2;
+        if (a[i] < tail[t]) {
+            *out++ = b[j] < a[i] ? b[j++] : a[i++];
+        } else {
+            *out++ = b[j] < tail[t] ? b[j++] : tail[t++];
+        }
+    }
+    if (t == nt) return comparisons + scalarMerge(a + i, na - i, b + j, nb - j, out);
+    if (i == na) return comparisons + scalarMerge(tail + t, nt - t, b + j, nb - j, out);
+    return comparisons + scalarMerge(tail + t, nt - t, a + i, na - i, out);
+}
+
+inline const SortKernels& scalarKernels() {
+    static const SortKernels kernels = {Level::Scalar, "scalar", 16, scalarSortBlock, scalarPartition, scalarMerge};
+    return kernels;
+}
+
+// Search kernels over int keys, dispatched the same way as the sort kernels
+struct SearchKernels {
+    Level level;
+    const char* name;
+    
+    // Index of the first element equal to key, or n
+    size_t (*find)(const int* data, size_t n, int key);
+    // Number of keys below key in a sorted node of kNodeKeys elements
+    unsigned (*nodeRank)(const int* node, int key);
+};
+
+// Keys per S-tree node: one 64-byte cache line of ints
+const size_t kNodeKeys = 16;
+
+inline size_t scalarFind(const int* data, size_t n, int key) {
+    for (size_t i = 0; i < n; ++i) {
+        if (data[i] == key) return i;
+    }
+    return n;
+}
+
+inline unsigned scalarNodeRank(const int* node, int key) {
+    unsigned rank = 0;
+    for (size_t i = 0; i < kNodeKeys; ++i) rank += node[i] < key;
+    return rank;
+}
+
+inline const SearchKernels& scalarSearchKernels() {
+    static const SearchKernels kernels = {Level::Scalar, "scalar", scalarFind, scalarNodeRank};
+    return kernels;
+}
+
+#ifdef ANALYZER_X86_SIMD
+
+// Lane permutations for partitioning 8 lanes: lanes whose mask bit is set first, the
+// others after them, both in lane order
+struct PartitionTable {
+    uint8_t lanes[256][8];
+    
+    PartitionTable() {
+        for (int mask = 0; mask < 256; ++mask) {
+            int out = 0;
+            for (int lane = 0; lane < 8; ++lane) if (mask & (1 << lane)) lanes[mask][out++] = lane;
+            for (int lane = 0; lane < 8; ++lane) if (!(mask & (1 << lane))) lanes[mask][out++] = lane;
+        }
+    }
+};
+
+inline const uint8_t* partitionPermutations() {
+    static const PartitionTable table;
+    return &table.lanes[0][0];
+}
+
+// Bitonic networks over registers of W lanes. Stage (k, j) compares element i with
+// i ^ j, ascending where i & k is zero; passing k beyond the range sorts all ascending.
+const int kAllAscending = 1 << 30;
+
+#define ANALYZER_AVX2 __attribute__((target("avx2")))
+
+ANALYZER_AVX2 inline __m256i exchangeAvx2(__m256i v, int base, int k, int j) {
+    const __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i partner = _mm256_permutevar8x32_epi32(v, _mm256_xor_si256(lane, _mm256_set1_epi32(j)));
+    __m256i index = _mm256_add_epi32(lane, _mm256_set1_epi32(base));
+    __m256i ascending = _mm256_cmpeq_epi32(_mm256_and_si256(index, _mm256_set1_epi32(k)), zero);
+    __m256i lower = _mm256_cmpeq_epi32(_mm256_and_si256(lane, _mm256_set1_epi32(j)), zero);
+    __m256i takeMax = _mm256_xor_si256(ascending, lower);
+    return _mm256_blendv_epi8(_mm256_min_epi32(v, partner), _mm256_max_epi32(v, partner), takeMax);
+}
+
+ANALYZER_AVX2 inline void bitonicSortAvx2(__m256i* v, int regs) {
+    const int n = regs * 8;
+    for (int k = 2; k <= n; k *= 2) {
+        for (int j = k / 2; j > 0; j /= 2) {
+            if (j >= 8) {
+                int step = j / 8;
+                for (int r = 0; r < regs; ++r) {
+                    if (r & step) continue;
+                    __m256i lo = _mm256_min_epi32(v[r], v[r + step]);
+                    __m256i hi = _mm256_max_epi32(v[r], v[r + step]);
+                    bool ascending = ((r * 8) & k) == 0;
+                    v[r] = ascending ? lo : hi;
+                    v[r + step] = ascending ? hi : lo;
+                }
+            } else {
+                for (int r = 0; r < regs; ++r) v[r] = exchangeAvx2(v[r], r * 8, k, j);
+            }
+        }
+    }
+}
+
+const size_t kAvx2Registers = 4;
+
+ANALYZER_AVX2 inline uint64_t sortBlockAvx2(int* data, size_t n) {
+    int padded[kAvx2Registers * 8];
+    for (size_t i = 0; i < kAvx2Registers * 8; ++i) padded[i] = i < n ? data[i] : numeric_limits<int>::max();
+    
+    __m256i v[kAvx2Registers];
+    for (size_t r = 0; r < kAvx2Registers; ++r) v[r] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(padded + r * 8));
+    bitonicSortAvx2(v, kAvx2Registers);
+    for (size_t r = 0; r < kAvx2Registers; ++r) _mm256_storeu_si256(reinterpret_cast<__m256i*>(padded + r * 8), v[r]);
+    
+    memcpy(data, padded, n * sizeof(int));
+    return 32 / 2 * (5 * 6 / 2);   // 16 comparators in each of 15 stages
+}
+
+// Stores the lanes of v below the pivot at leftWrite and the others ending at rightWrite.
+// Both stores write the whole permuted register, so each side needs a register of free space.
+ANALYZER_AVX2 inline void distributeAvx2(int* data, __m256i v, __m256i pivots, const uint8_t* permutations,
+                                         size_t& leftWrite, size_t& rightWrite) {
+    int mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(pivots, v)));
+    __m128i packed = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(permutations + mask * 8));
+    __m256i sorted = _mm256_permutevar8x32_epi32(v, _mm256_cvtepu8_epi32(packed));
+    int below = __builtin_popcount(mask);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + leftWrite), sorted);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + rightWrite - 8), sorted);
+    leftWrite += below;
+    rightWrite -= 8 - below;
+}
+
+// In-place partition that keeps one register from each end in flight and always reads from
+// the side with less free space, so every store lands in already-consumed slots
+ANALYZER_AVX2 inline size_t partitionAvx2(int* data, size_t n, int pivot) {
+    const size_t W = 8;
+    if (n < 2 * W) return scalarPartition(data, n, pivot);
+    
+    const uint8_t* permutations = partitionPermutations();
+    const __m256i pivots = _mm256_set1_epi32(pivot);
+    size_t leftWrite = 0, rightWrite = n, leftRead = W, rightRead = n - W;
+    const __m256i first = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+    const __m256i last = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + n - W));
+    
+    while (rightRead - leftRead >= W) {
+        __m256i v;
+        if (leftRead - leftWrite <= rightWrite - rightRead) {
+            v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + leftRead));
+            leftRead += W;
+        } else {
+            rightRead -= W;
+            v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + rightRead));
+        }
+        distributeAvx2(data, v, pivots, permutations, leftWrite, rightWrite);
+    }
+    
+    // Fewer than W unread elements remain; once copied out, [leftWrite, rightWrite) is free
+    int rest[W];
+    size_t restCount = rightRead - leftRead;
+    memcpy(rest, data + leftRead, restCount * sizeof(int));
+    for (size_t i = 0; i < restCount; ++i) {
+        if (rest[i] < pivot) data[leftWrite++] = rest[i];
+        else data[--rightWrite] = rest[i];
+    }
+    distributeAvx2(data, first, pivots, permutations, leftWrite, rightWrite);
+    distributeAvx2(data, last, pivots, permutations, leftWrite, rightWrite);
+    return leftWrite;
+}
+
+// Merges sorted registers a and b: a receives the lower half, b the upper half, both sorted
+ANALYZER_AVX2 inline void mergeRegistersAvx2(__m256i& a, __m256i& b) {
+    __m256i reversed = _mm256_permutevar8x32_epi32(b, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+    __m256i lo = _mm256_min_epi32(a, reversed);
+    __m256i hi = _mm256_max_epi32(a, reversed);
+    for (int j = 4; j > 0; j /= 2) {
+        lo = exchangeAvx2(lo, 0, kAllAscending, j);
+        hi = exchangeAvx2(hi, 0, kAllAscending, j);
+    }
+    a = lo;
+    b = hi;
+}
+
+ANALYZER_AVX2 inline uint64_t mergeAvx2(const int* a, size_t na, const int* b, size_t nb, int* out) {
+    const size_t W = 8;
+    if (na < W || nb < W) return scalarMerge(a, na, b, nb, out);
+    
+    __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a));
+    __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b));
+    size_t i = W, j = W;
+    uint64_t comparisons = 0;
+    while (true) {
+        mergeRegistersAvx2(low, high);
+        comparisons += W * 4;     // 8 comparators in each of 4 stages
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), low);
+        out += W;
+        
+        // Refill from the input with the smaller head; stop when it has no full register left
+        bool fromA = j == nb || (i < na && a[i] <= b[j]);
+        if (fromA && i + W <= na) {
+            low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+            i += W;
+        } else if (!fromA && j + W <= nb) {
+            low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + j));
+            j += W;
+        } else {
+            break;
+        }
+    }
+    
+    int tail[W];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(tail), high);
+    return comparisons + scalarMergeTail(tail, W, a + i, na - i, b + j, nb - j, out);
+}
+
+inline const SortKernels& avx2Kernels() {
+    static const SortKernels kernels = {Level::Avx2, "avx2", kAvx2Registers * 8, sortBlockAvx2, partitionAvx2, mergeAvx2};
+    return kernels;
+}
+
+// Compares four registers per iteration and only locates the lane once any of them matched
+ANALYZER_AVX2 inline size_t findAvx2(const int* data, size_t n, int key) {
+    const __m256i keys = _mm256_set1_epi32(key);
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        const __m256i* block = reinterpret_cast<const __m256i*>(data + i);
+        __m256i a = _mm256_cmpeq_epi32(_mm256_loadu_si256(block), keys);
+        __m256i b = _mm256_cmpeq_epi32(_mm256_loadu_si256(block + 1), keys);
+        __m256i c = _mm256_cmpeq_epi32(_mm256_loadu_si256(block + 2), keys);
+        __m256i d = _mm256_cmpeq_epi32(_mm256_loadu_si256(block + 3), keys);
+        __m256i any = _mm256_or_si256(_mm256_or_si256(a, b), _mm256_or_si256(c, d));
+        if (!_mm256_testz_si256(any, any)) break;
+    }
+    for (; i + 8 <= n; i += 8) {
+        __m256i equal = _mm256_cmpeq_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)), keys);
+        int mask = _mm256_movemask_ps(_mm256_castsi256_ps(equal));
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    return i + scalarFind(data + i, n - i, key);
+}
+
+ANALYZER_AVX2 inline unsigned nodeRankAvx2(const int* node, int key) {
+    const __m256i keys = _mm256_set1_epi32(key);
+    __m256i lo = _mm256_cmpgt_epi32(keys, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(node)));
+    __m256i hi = _mm256_cmpgt_epi32(keys, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(node + 8)));
+    return __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(lo)))
+         + __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(hi)));
+}
+
+inline const SearchKernels& avx2SearchKernels() {
+    static const SearchKernels kernels = {Level::Avx2, "avx2", findAvx2, nodeRankAvx2};
+    return kernels;
+}
+
+#define ANALYZER_AVX512 __attribute__((target("avx512f")))
+
+ANALYZER_AVX512 inline __m512i exchangeAvx512(__m512i v, int base, int k, int j) {
+    const __m512i lane = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    __m512i partner = _mm512_permutexvar_epi32(_mm512_xor_si512(lane, _mm512_set1_epi32(j)), v);
+    __m512i index = _mm512_add_epi32(lane, _mm512_set1_epi32(base));
+    __mmask16 ascending = _mm512_testn_epi32_mask(index, _mm512_set1_epi32(k));
+    __mmask16 lower = _mm512_testn_epi32_mask(lane, _mm512_set1_epi32(j));
+    return _mm512_mask_blend_epi32(ascending ^ lower, _mm512_min_epi32(v, partner), _mm512_max_epi32(v, partner));
+}
+
+ANALYZER_AVX512 inline void bitonicSortAvx512(__m512i* v, int regs) {
+    const int n = regs * 16;
+    for (int k = 2; k <= n; k *= 2) {
+        for (int j = k / 2; j > 0; j /= 2) {
+            if (j >= 16) {
+                int step = j / 16;
+                for (int r = 0; r < regs; ++r) {
+                    if (r & step) continue;
+                    __m512i lo = _mm512_min_epi32(v[r], v[r + step]);
+                    __m512i hi = _mm512_max_epi32(v[r], v[r + step]);
+                    bool ascending = ((r * 16) & k) == 0;
+                    v[r] = ascending ? lo : hi;
+                    v[r + step] = ascending ? hi : lo;
+                }
+            } else {
+                for (int r = 0; r < regs; ++r) v[r] = exchangeAvx512(v[r], r * 16, k, j);
+            }
+        }
+    }
+}
+
+const size_t kAvx512Registers = 4;
+
+ANALYZER_AVX512 inline uint64_t sortBlockAvx512(int* data, size_t n) {
+    __m512i v[kAvx512Registers];
+    const __m512i padding = _mm512_set1_epi32(numeric_limits<int>::max());
+    for (size_t r = 0; r < kAvx512Registers; ++r) {
+        size_t begin = min(n, r * 16), count = min<size_t>(16, n - begin);
+        __mmask16 valid = static_cast<__mmask16>((1u << count) - 1);
+        v[r] = _mm512_mask_loadu_epi32(padding, valid, data + begin);
+    }
+    bitonicSortAvx512(v, kAvx512Registers);
+    for (size_t r = 0; r < kAvx512Registers; ++r) {
+        size_t begin = min(n, r * 16), count = min<size_t>(16, n - begin);
+        _mm512_mask_storeu_epi32(data + begin, static_cast<__mmask16>((1u << count) - 1), v[r]);
+    }
+    return 64 / 2 * (6 * 7 / 2);   // 32 comparators in each of 21 stages
+}
+
+// Compress-stores the valid lanes of v below the pivot at leftWrite and the others ending at rightWrite
+ANALYZER_AVX512 inline void distributeAvx512(int* data, __m512i v, __mmask16 valid, __m512i pivots,
+                                             size_t& leftWrite, size_t& rightWrite) {
+    __mmask16 mask = _mm512_mask_cmplt_epi32_mask(valid, v, pivots);
+    int below = __builtin_popcount(mask);
+    int above = __builtin_popcount(valid) - below;
+    _mm512_mask_compressstoreu_epi32(data + leftWrite, mask, v);
+    _mm512_mask_compressstoreu_epi32(data + rightWrite - above, valid & static_cast<__mmask16>(~mask), v);
+    leftWrite += below;
+    rightWrite -= above;
+}
+
+// Same scheme as partitionAvx2, with compress stores instead of a permutation table
+ANALYZER_AVX512 inline size_t partitionAvx512(int* data, size_t n, int pivot) {
+    const size_t W = 16;
+    if (n < 2 * W) return scalarPartition(data, n, pivot);
+    
+    const __m512i pivots = _mm512_set1_epi32(pivot);
+    const __mmask16 all = 0xFFFF;
+    size_t leftWrite = 0, rightWrite = n, leftRead = W, rightRead = n - W;
+    const __m512i first = _mm512_loadu_si512(data);
+    const __m512i last = _mm512_loadu_si512(data + n - W);
+    
+    while (rightRead - leftRead >= W) {
+        __m512i v;
+        if (leftRead - leftWrite <= rightWrite - rightRead) {
+            v = _mm512_loadu_si512(data + leftRead);
+            leftRead += W;
+        } else {
+            rightRead -= W;
+            v = _mm512_loadu_si512(data + rightRead);
+        }
+        distributeAvx512(data, v, all, pivots, leftWrite, rightWrite);
+    }
+    
+    // The unread rest fits in one masked register; once loaded, [leftWrite, rightWrite) is free
+    __mmask16 rest = static_cast<__mmask16>((1u << (rightRead - leftRead)) - 1);
+    distributeAvx512(data, _mm512_maskz_loadu_epi32(rest, data + leftRead), rest, pivots, leftWrite, rightWrite);
+    distributeAvx512(data, first, all, pivots, leftWrite, rightWrite);
+    distributeAvx512(data, last, all, pivots, leftWrite, rightWrite);
+    return leftWrite;
+}
+
+ANALYZER_AVX512 inline void mergeRegistersAvx512(__m512i& a, __m512i& b) {
+    const __m512i reverse = _mm512_setr_epi32(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+    __m512i reversed = _mm512_permutexvar_epi32(reverse, b);
+    __m512i lo = _mm512_min_epi32(a, reversed);
+    __m512i hi = _mm512_max_epi32(a, reversed);
+    for (int j = 8; j > 0; j /= 2) {
+        lo = exchangeAvx512(lo, 0, kAllAscending, j);
+        hi = exchangeAvx512(hi, 0, kAllAscending, j);
+    }
+    a = lo;
+    b = hi;
+}
+
+ANALYZER_AVX512 inline uint64_t mergeAvx512(const int* a, size_t na, const int* b, size_t nb, int* out) {
+    const size_t W = 16;
+    if (na < W || nb < W) return scalarMerge(a, na, b, nb, out);
+    
+    __m512i low = _mm512_loadu_si512(a);
+    __m512i high = _mm512_loadu_si512(b);
+    size_t i = W, j = W;
+    uint64_t comparisons = 0;
+    while (true) {
+        mergeRegistersAvx512(low, high);
+        comparisons += W * 5;     // 16 comparators in each of 5 stages
+        _mm512_storeu_si512(out, low);
+        out += W;
+        
+        bool fromA = j == nb || (i < na && a[i] <= b[j]);
+        if (fromA && i + W <= na) {
+            low = _mm512_loadu_si512(a + i);
+            i += W;
+        } else if (!fromA && j + W <= nb) {
+            low = _mm512_loadu_si512(b + j);
+            j += W;
+        } else {
+            break;
+        }
+    }
+    
+    int tail[W];
+    _mm512_storeu_si512(tail, high);
+    return comparisons + scalarMergeTail(tail, W, a + i, na - i, b + j, nb - j, out);
+}
+
+inline const SortKernels& avx512Kernels() {
+    static const SortKernels kernels = {Level::Avx512, "avx512", kAvx512Registers * 16,
+                                        sortBlockAvx512, partitionAvx512, mergeAvx512};
+    return kernels;
+}
+
+ANALYZER_AVX512 inline size_t findAvx512(const int* data, size_t n, int key) {
+    const __m512i keys = _mm512_set1_epi32(key);
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        __mmask16 a = _mm512_cmpeq_epi32_mask(_mm512_loadu_si512(data + i), keys);
+        __mmask16 b = _mm512_cmpeq_epi32_mask(_mm512_loadu_si512(data + i + 16), keys);
+        __mmask16 c = _mm512_cmpeq_epi32_mask(_mm512_loadu_si512(data + i + 32), keys);
+        __mmask16 d = _mm512_cmpeq_epi32_mask(_mm512_loadu_si512(data + i + 48), keys);
+        if (a | b | c | d) break;
+    }
+    for (; i < n; i += 16) {
+        __mmask16 valid = n - i >= 16 ? 0xFFFF : static_cast<__mmask16>((1u << (n - i)) - 1);
+        __mmask16 equal = _mm512_mask_cmpeq_epi32_mask(valid, _mm512_maskz_loadu_epi32(valid, data + i), keys);
+        if (equal) return i + __builtin_ctz(equal);
+    }
+    return n;
+}
+
+ANALYZER_AVX512 inline unsigned nodeRankAvx512(const int* node, int key) {
+    return __builtin_popcount(_mm512_cmplt_epi32_mask(_mm512_loadu_si512(node), _mm512_set1_epi32(key)));
+}
+
+inline const SearchKernels& avx512SearchKernels() {
+    static const SearchKernels kernels = {Level::Avx512, "avx512", findAvx512, nodeRankAvx512};
+    return kernels;
+}
+
+#endif // ANALYZER_X86_SIMD
+
+// Widest instruction set this build and CPU both support
+inline Level bestLevel() {
+#ifdef ANALYZER_X86_SIMD
+    if (__builtin_cpu_supports("avx512f")) return Level::Avx512;
+    if (__builtin_cpu_supports("avx2")) return Level::Avx2;
+#endif
+    return Level::Scalar;
+}
+
+// Kernels for the requested level, or for the best supported level below it
+inline const SortKernels& kernelsFor(Level level) {
+    Level best = bestLevel();
+    if (static_cast<int>(level) > static_cast<int>(best)) level = best;
+#ifdef ANALYZER_X86_SIMD
+    if (level == Level::Avx512) return avx512Kernels();
+    if (level == Level::Avx2) return avx2Kernels();
+#endif
+    return scalarKernels();
+}
+
+inline const SearchKernels& searchKernelsFor(Level level) {
+    Level best = bestLevel();
+    if (static_cast<int>(level) > static_cast<int>(best)) level = best;
+#ifdef ANALYZER_X86_SIMD
+    if (level == Level::Avx512) return avx512SearchKernels();
+    if (level == Level::Avx2) return avx2SearchKernels();
+#endif
+    return scalarSearchKernels();
+}
+
+inline bool parseLevel(const string& name, Level& level) {
+    if (name == "auto") level = bestLevel();
+    else if (name == "avx512") level = Level::Avx512;
+    else if (name == "avx2") level = Level::Avx2;
+    else if (name == "scalar") level = Level::Scalar;
+    else return false;
+    return true;
+}
+
+} // namespace simd
+
+// Generic sorts and searches over random-access iterators and a strict weak
+// ordering. Every algorithm reports its work through an operation policy.
+namespace algorithms {
+
+// Returns the first element equivalent to target, or last
+template <class RandomIt, class T, class Compare, class Ops>
+RandomIt linearSearch(RandomIt first, RandomIt last, const T& target, Compare comp, Ops& ops) {
+    for (RandomIt it = first; it != last; ++it) {
+        size_t i = it - first;
+        ops.step(StepKind::Visit, i, i);
+        ops.compare(i, i);
+        if (!comp(*it, target) && !comp(target, *it)) return it;
+    }
+    return last;
+}
+
+// Expects a sorted range; returns an element equivalent to target, or last
+template <class RandomIt, class T, class Compare, class Ops>
+RandomIt binarySearch(RandomIt first, RandomIt last, const T& target, Compare comp, Ops& ops) {
+    ptrdiff_t left = 0, right = (last - first) - 1;
+    
+    while (left <= right) {
+        ptrdiff_t mid = left + (right - left) / 2;
+        ops.step(StepKind::Probe, left, right, mid);
+        
+        ops.compare(mid, mid);
+        if (comp(first[mid], target)) {
+            left = mid + 1;
+            continue;
+        }
+        ops.compare(mid, mid);
+        if (comp(target, first[mid])) {
+            right = mid - 1;
+        } else {
+            return first + mid;
+        }
+    }
+    return last;
+}
+
+// Bubble sort with early exit when a pass makes no swaps
+template <class RandomIt, class Compare, class Ops>
+void bubbleSort(RandomIt first, RandomIt last, Compare comp, Ops& ops) {
+    size_t n = last - first;
+    
+    for (size_t i = 0; i + 1 < n; ++i) {
+        bool swapped = false;
+        ops.step(StepKind::Pass, i + 1, 0);
+        
+        for (size_t j = 0; j + 1 < n - i; ++j) {
+            ops.compare(j, j + 1);
+            if (comp(first[j + 1], first[j])) {
+                iter_swap(first + j, first + j + 1);
+                ops.swap(j, j + 1);
+                swapped = true;
+            }
+        }
+        
+        if (!swapped) break;
+    }
+}
+
+template <class RandomIt, class Compare, class Ops>
+void selectionSort(RandomIt first, RandomIt last, Compare comp, Ops& ops) {
+    size_t n = last - first;
+    
+    for (size_t i = 0; i + 1 < n; ++i) {
+        size_t minIdx = i;
+        ops.step(StepKind::Scan, i, n - 1);
+        
+        for (size_t j = i + 1; j < n; ++j) {
+            ops.compare(j, minIdx);
+            if (comp(first[j], first[minIdx])) {
+                minIdx = j;
+            }
+        }
+        
+        if (minIdx != i) {
+            iter_swap(first + i, first + minIdx);
+            ops.swap(i, minIdx);
+        }
+    }
+}
+
+// Insertion sort of the offsets [lo, hi)
+template <class RandomIt, class Compare, class Ops>
+void insertionSortRange(RandomIt first, ptrdiff_t lo, ptrdiff_t hi, Compare comp, Ops& ops) {
+    typedef typename iterator_traits<RandomIt>::value_type T;
+    
+    for (ptrdiff_t i = lo + 1; i < hi; ++i) {
+        ops.step(StepKind::Insert, i, 0);
+        T key = std::move(first[i]);
+        ptrdiff_t j = i;
+        
+        while (j > lo && (ops.compare(j - 1, i), comp(key, first[j - 1]))) {
+            first[j] = std::move(first[j - 1]);
+            ops.write(j);
+            --j;
+        }
+        first[j] = std::move(key);
+        ops.write(j);
+    }
+}
+
+template <class RandomIt, class Compare, class Ops>
+void insertionSort(RandomIt first, RandomIt last, Compare comp, Ops& ops) {
+    insertionSortRange(first, 0, last - first, comp, ops);
+}
+
+// Sorting networks generated at compile time from Knuth's merge exchange (Batcher's
+// odd-even merge for any n): every comparator position is a template argument, so the
+// network unrolls into straight-line compare-exchanges without loops or index arithmetic.
+// They are size-optimal up to 8 elements and a few comparators above the best known
+// networks beyond (63 vs 60 at 16, 191 vs 185 at 32). Networks work on plain pointers and
+// report to the operation policy once per run, which keeps their instantiations few.
+const size_t kNetworkMax = 32;
+
+template <size_t I, size_t J, bool Active>
+struct CompareExchange {
+    static const size_t comparators = 1;
+    
+    template <class T, class Compare>
+    static void apply(T* a, Compare comp) {
+        // Both stores happen either way, which compiles to conditional moves
+        bool out = comp(a[J], a[I]);
+        T low = out ? a[J] : a[I];
+        T high = out ? a[I] : a[J];
+        a[I] = std::move(low);
+        a[J] = std::move(high);
+    }
+};
+
+template <size_t I, size_t J>
+struct CompareExchange<I, J, false> {
+    static const size_t comparators = 0;
+    
+    template <class T, class Compare>
+    static void apply(T*, Compare) {}
+};
+
+// Comparators (i, i + D) for i from I while i + D < N, limited to (i & P) == R
+template <size_t N, size_t P, size_t R, size_t D, size_t I, bool Done = (I + D >= N)>
+struct MergeExchangeRow {
+    typedef CompareExchange<I, I + D, (I & P) == R> Head;
+    typedef MergeExchangeRow<N, P, R, D, I + 1> Tail;
+    static const size_t comparators = Head::comparators + Tail::comparators;
+    
+    template <class T, class Compare>
+    static void apply(T* a, Compare comp) {
+        Head::apply(a, comp);
+        Tail::apply(a, comp);
+    }
+};
+
+template <size_t N, size_t P, size_t R, size_t D, size_t I>
+struct MergeExchangeRow<N, P, R, D, I, true> {
+    static const size_t comparators = 0;
+    
+    template <class T, class Compare>
+    static void apply(T*, Compare) {}
+};
+
+// Rounds of one pass: d = p first, then d = q - p with q halving, until d is 0
+template <size_t N, size_t P, size_t Q, size_t R, size_t D>
+struct MergeExchangeRound {
+    typedef MergeExchangeRow<N, P, R, D, 0> Row;
+    typedef MergeExchangeRound<N, P, Q / 2, P, Q - P> Next;
+    static const size_t comparators = Row::comparators + Next::comparators;
+    
+    template <class T, class Compare>
+    static void apply(T* a, Compare comp) {
+        Row::apply(a, comp);
+        Next::apply(a, comp);
+    }
+};
+
+template <size_t N, size_t P, size_t Q, size_t R>
+struct MergeExchangeRound<N, P, Q, R, 0> {
+    static const size_t comparators = 0;
+    
+    template <class T, class Compare>
+    static void apply(T*, Compare) {}
+};
+
+// Passes for p = T, T/2, ..., 1 with T the largest power of two below N
+template <size_t N, size_t T, size_t P>
+struct MergeExchangePass {
+    typedef MergeExchangeRound<N, P, T, 0, P> Round;
+    typedef MergeExchangePass<N, T, P / 2> Next;
+    static const size_t comparators = Round::comparators + Next::comparators;
+    
+    template <class T2, class Compare>
+    static void apply(T2* a, Compare comp) {
+        Round::apply(a, comp);
+        Next::apply(a, comp);
+    }
+};
+
+template <size_t N, size_t T>
+struct MergeExchangePass<N, T, 0> {
+    static const size_t comparators = 0;
+    
+    template <class T2, class Compare>
+    static void apply(T2*, Compare) {}
+};
+
+template <size_t N, size_t T = 1, bool Done = (2 * T >= N)>
+struct HighestPowerBelow {
+    static const size_t value = HighestPowerBelow<N, 2 * T>::value;
+};
+
+template <size_t N, size_t T>
+struct HighestPowerBelow<N, T, true> {
+    static const size_t value = T;
+};
+
+// Returns the number of comparators, a compile-time constant per size
+template <size_t N>
+struct SortingNetwork {
+    typedef MergeExchangePass<N, HighestPowerBelow<N>::value, HighestPowerBelow<N>::value> Passes;
+    
+    template <class T, class Compare>
+    static size_t sort(T* a, Compare comp) {
+        Passes::apply(a, comp);
+        return Passes::comparators;
+    }
+};
+
+template <>
+struct SortingNetwork<0> {
+    template <class T, class Compare>
+    static size_t sort(T*, Compare) { return 0; }
+};
+
+template <>
+struct SortingNetwork<1> : SortingNetwork<0> {};
+
+// One network per size, indexed by n
+template <class T, class Compare>
+class NetworkTable {
+private:
+    typedef size_t (*Sorter)(T*, Compare);
+    Sorter sorters[kNetworkMax + 1];
+    
+    template <size_t N>
+    void fill(integral_constant<size_t, N>) {
+        sorters[N] = &SortingNetwork<N>::template sort<T, Compare>;
+        fill(integral_constant<size_t, N - 1>());
+    }
+    
+    void fill(integral_constant<size_t, 0>) {
+        sorters[0] = &SortingNetwork<0>::template sort<T, Compare>;
+    }
+    
+public:
+    NetworkTable() { fill(integral_constant<size_t, kNetworkMax>()); }
+    
+    size_t sort(T* a, size_t n, Compare comp) const { return sorters[n](a, comp); }
+};
+
+// Sorts up to kNetworkMax elements with the network for their exact count. Like a SIMD
+// kernel call, the whole network is reported as one step of comparators and writes.
+template <class RandomIt, class Compare, class Ops>
+void networkSort(RandomIt first, RandomIt last, Compare comp, Ops& ops) {
+    typedef typename iterator_traits<RandomIt>::value_type T;
+    static const NetworkTable<T, Compare> table;
+    size_t n = last - first;
+    if (n < 2) return;
+    size_t comparators = table.sort(&*first, n, comp);
+    ops.vectorStep(comparators, 2 * comparators);
+}
+
+// Lomuto partition around the last element; returns the pivot's final offset
+template <class RandomIt, class Compare, class Ops>
+ptrdiff_t partition(RandomIt first, ptrdiff_t low, ptrdiff_t high, Compare comp, Ops& ops) {
+    ops.step(StepKind::Partition, low, high);
+    ptrdiff_t i = low - 1;
+    
+    for (ptrdiff_t j = low; j < high; ++j) {
+        ops.compare(j, high);
+        if (comp(first[j], first[high])) {
+            ++i;
+            iter_swap(first + i, first + j);
+            ops.swap(i, j);
+        }
+    }
+    iter_swap(first + i + 1, first + high);
+    ops.swap(i + 1, high);
+    ops.step(StepKind::PivotPlaced, i + 1, i + 1);
+    
+    return i + 1;
+}
+
+template <class RandomIt, class Compare, class Ops>
+void quickSortRange(RandomIt first, ptrdiff_t low, ptrdiff_t high, Compare comp, Ops& ops) {
+    if (low < high) {
+        ptrdiff_t pi = partition(first, low, high, comp, ops);
+        quickSortRange(first, low, pi - 1, comp, ops);
+        quickSortRange(first, pi + 1, high, comp, ops);
+    }
+}
+
+template <class RandomIt, class Compare, class Ops>
+void quickSort(RandomIt first, RandomIt last, Compare comp, Ops& ops) {
+    quickSortRange(first, 0, (last - first) - 1, comp, ops);
+}
+
+// Merges [left, mid] and [mid + 1, right] through two freshly allocated halves
+template <class RandomIt, class Compare, class Ops>
+void merge(RandomIt first, ptrdiff_t left, ptrdiff_t mid, ptrdiff_t right, Compare comp, Ops& ops) {
+    typedef typename iterator_traits<RandomIt>::value_type T;
+    ops.step(StepKind::Merge, left, right, mid);
+    
+    ptrdiff_t n1 = mid - left + 1;
+    ptrdiff_t n2 = right - mid;
+    
+    vector<T> L(first + left, first + mid + 1), R(first + mid + 1, first + right + 1);
+    ops.allocate(n1 * sizeof(T));
+    ops.allocate(n2 * sizeof(T));
+    ops.bufferWrite(n1 + n2);
+    
+    ptrdiff_t i = 0, j = 0, k = left;
+    
+    while (i < n1 && j < n2) {
+        ops.compare(left + i, mid + 1 + j);
+        if (!comp(R[j], L[i])) {
+            first[k] = std::move(L[i++]);
+        } else {
+            first[k] = std::move(R[j++]);
+        }
+        ops.write(k++);
+    }
+    
+    while (i < n1) {
+        first[k] = std::move(L[i++]);
+        ops.write(k++);
+    }
+    while (j < n2) {
+        first[k] = std::move(R[j++]);
+        ops.write(k++);
+    }
+    
+    ops.step(StepKind::Merged, left, right);
+}
+
+template <class RandomIt, class Compare, class Ops>
+void mergeSortRange(RandomIt first, ptrdiff_t left, ptrdiff_t right, Compare comp, Ops& ops) {
+    if (left < right) {
+        ptrdiff_t mid = left + (right - left) / 2;
+        ops.step(StepKind::Divide, left, right, mid);
+        
+        mergeSortRange(first, left, mid, comp, ops);
+        mergeSortRange(first, mid + 1, right, comp, ops);
+        merge(first, left, mid, right, comp, ops);
+    }
+}
+
+template <class RandomIt, class Compare, class Ops>
+void mergeSort(RandomIt first, RandomIt last, Compare comp, Ops& ops) {
+    mergeSortRange(first, 0, (last - first) - 1, comp, ops);
+}
+
+// Policy used inside parallel tasks: counting policies tally privately and are
+// merged once per task, so workers never share a counter. NullOps stays free.
+template <class Ops>
+struct TaskOps {
+    typedef CountingOps type;
+};
+
+template <>
+struct TaskOps<NullOps> {
+    typedef NullOps type;
+};
+
+inline void absorb(NullOps&, const NullOps&, mutex&) {}
+
+inline void absorb(CountingOps& target, const CountingOps& task, mutex& lock) {
+    lock_guard<mutex> guard(lock);
+    target.counts += task.counts;
+}
+
+// Moves the median of first[low], first[mid], first[high] into first[high]
+template <class RandomIt, class Compare, class Ops>
+void medianOfThreeToHigh(RandomIt first, ptrdiff_t low, ptrdiff_t high, Compare comp, Ops& ops) {
+    ptrdiff_t mid = low + (high - low) / 2;
+    
+    ops.compare(mid, low);
+    if (comp(first[mid], first[low])) {
+        iter_swap(first + mid, first + low);
+        ops.swap(mid, low);
+    }
+    ops.compare(high, low);
+    if (comp(first[high], first[low])) {
+        iter_swap(first + high, first + low);
+        ops.swap(high, low);
+    }
+    ops.compare(mid, high);
+    if (comp(first[mid], first[high])) {
+        iter_swap(first + mid, first + high);
+        ops.swap(mid, high);
+    }
+}
+
+// Restores the max-heap property below root in the heap stored at offsets [lo, lo + n)
+template <class RandomIt, class Compare, class Ops>
+void siftDown(RandomIt first, ptrdiff_t lo, ptrdiff_t root, ptrdiff_t n, Compare comp, Ops& ops) {
+    ptrdiff_t child;
+    while ((child = 2 * root + 1) < n) {
+        if (child + 1 < n) {
+            ops.compare(lo + child, lo + child + 1);
+            if (comp(first[lo + child], first[lo + child + 1])) ++child;
+        }
+        ops.compare(lo + root, lo + child);
+        if (!comp(first[lo + root], first[lo + child])) return;
+        
+        iter_swap(first + lo + root, first + lo + child);
+        ops.swap(lo + root, lo + child);
+        root = child;
+    }
+}
+
+// Heapsort of the offsets [lo, hi); introsort's fallback once recursion gets too deep
+template <class RandomIt, class Compare, class Ops>
+void heapSortRange(RandomIt first, ptrdiff_t lo, ptrdiff_t hi, Compare comp, Ops& ops) {
+    ptrdiff_t n = hi - lo;
+    for (ptrdiff_t start = n / 2 - 1; start >= 0; --start) {
+        siftDown(first, lo, start, n, comp, ops);
+    }
+    for (ptrdiff_t end = n - 1; end > 0; --end) {
+        iter_swap(first + lo, first + lo + end);
+        ops.swap(lo, lo + end);
+        siftDown(first, lo, 0, end, comp, ops);
+    }
+}
+
+template <class RandomIt, class Compare, class Ops>
+ptrdiff_t medianOfThree(RandomIt first, ptrdiff_t a, ptrdiff_t b, ptrdiff_t c, Compare comp, Ops& ops) {
+    ops.compare(a, b);
+    if (comp(first[a], first[b])) {
+        ops.compare(b, c);
+        if (comp(first[b], first[c])) return b;
+        ops.compare(a, c);
+        return comp(first[a], first[c]) ? c : a;
+    }
+    ops.compare(a, c);
+    if (comp(first[a], first[c])) return a;
+    ops.compare(b, c);
+    return comp(first[b], first[c]) ? c : b;
+}
+
+const ptrdiff_t kIntroInsertionCutoff = 16;
+const ptrdiff_t kNintherThreshold = 128;
+
+// Moves the pivot of [lo, hi) to hi - 1: the median of three for small ranges, Tukey's
+// ninther for large ones
+template <class RandomIt, class Compare, class Ops>
+void selectPivot(RandomIt first, ptrdiff_t lo, ptrdiff_t hi, Compare comp, Ops& ops) {
+    ptrdiff_t n = hi - lo;
+    ptrdiff_t mid = lo + n / 2;
+    ptrdiff_t pivotIndex;
+    if (n > kNintherThreshold) {
+        ptrdiff_t step = n / 8;
+        pivotIndex = medianOfThree(first,
+            medianOfThree(first, lo, lo + step, lo + 2 * step, comp, ops),
+            medianOfThree(first, mid - step, mid, mid + step, comp, ops),
+            medianOfThree(first, hi - 1 - 2 * step, hi - 1 - step, hi - 1, comp, ops),
+            comp, ops);
+    } else {
+        pivotIndex = medianOfThree(first, lo, mid, hi - 1, comp, ops);
+    }
+    if (pivotIndex != hi - 1) {
+        iter_swap(first + pivotIndex, first + hi - 1);
+        ops.swap(pivotIndex, hi - 1);
+    }
+}
+
+// Three-way partition around the pivot at hi - 1: [lo, lt) < pivot, [lt, gt) == pivot,
+// [gt, hi) > pivot. Runs of equal keys settle in one pass instead of splitting n - 1 : 0.
+template <class RandomIt, class Compare, class Ops>
+void partitionThreeWay(RandomIt first, ptrdiff_t lo, ptrdiff_t hi, Compare comp, Ops& ops,
+                       ptrdiff_t& lt, ptrdiff_t& gt) {
+    typedef typename iterator_traits<RandomIt>::value_type T;
+    
+    ops.step(StepKind::Partition, lo, hi - 1);
+    T pivot = first[hi - 1];
+    ptrdiff_t i = lo;
+    lt = lo;
+    gt = hi;
+    while (i < gt) {
+        ops.compare(i, hi - 1);
+        if (comp(first[i], pivot)) {
+            if (lt != i) {
+                iter_swap(first + lt, first + i);
+                ops.swap(lt, i);
+            }
+            ++lt;
+            ++i;
+            continue;
+        }
+        ops.compare(i, hi - 1);
+        if (comp(pivot, first[i])) {
+            --gt;
+            iter_swap(first + i, first + gt);
+            ops.swap(i, gt);
+        } else {
+            ++i;
+        }
+    }
+    ops.step(StepKind::PivotPlaced, lt, gt - 1);
+}
+
+template <class RandomIt, class Compare, class Ops>
+void introSortLoop(RandomIt first, ptrdiff_t lo, ptrdiff_t hi, int depthLimit, Compare comp, Ops& ops) {
+    while (hi - lo > kIntroInsertionCutoff) {
+        if (depthLimit-- == 0) {
+            heapSortRange(first, lo, hi, comp, ops);
+            return;
+        }
+        
+        selectPivot(first, lo, hi, comp, ops);
+        ptrdiff_t lt, gt;
+        partitionThreeWay(first, lo, hi, comp, ops, lt, gt);
+        
+        // Recurse into the smaller side and loop on the larger, bounding the stack at O(log n)
+        if (lt - lo < hi - gt) {
+            introSortLoop(first, lo, lt, depthLimit, comp, ops);
+            lo = gt;
+        } else {
+            introSortLoop(first, gt, hi, depthLimit, comp, ops);
+            hi = lt;
+        }
+    }
+    
+    insertionSortRange(first, lo, hi, comp, ops);
+}
+
+// Hardened quicksort: ninther pivots, three-way partitioning, smaller-side recursion,
+// insertion sort below a cutoff and a heapsort fallback past 2*log2(n) levels
+template <class RandomIt, class Compare, class Ops>
+void introSort(RandomIt first, RandomIt last, Compare comp, Ops& ops) {
+    ptrdiff_t n = last - first;
+    int depthLimit = 0;
+    for (ptrdiff_t k = n; k > 1; k >>= 1) depthLimit += 2;
+    introSortLoop(first, 0, n, depthLimit, comp, ops);
+}
+
+// Merges sorted [lo, mid) and [mid, hi) after moving the left run into the scratch buffer
+template <class RandomIt, class BufferIt, class Compare, class Ops>
+void mergeWithBuffer(RandomIt first, BufferIt buffer, ptrdiff_t lo, ptrdiff_t mid, ptrdiff_t hi,
+                     Compare comp, Ops& ops) {
+    ops.step(StepKind::Merge, lo, hi - 1, mid - 1);
+    std::move(first + lo, first + mid, buffer + lo);
+    ops.bufferWrite(mid - lo);
+    
+    ptrdiff_t i = lo, j = mid, k = lo;
+    while (i < mid && j < hi) {
+        ops.compare(i, j);
+        if (comp(first[j], buffer[i])) {
+            first[k] = std::move(first[j++]);
+        } else {
+            first[k] = std::move(buffer[i++]);
+        }
+        ops.write(k++);
+    }
+    while (i < mid) {
+        first[k] = std::move(buffer[i++]);
+        ops.write(k++);
+    }
+    
+    ops.step(StepKind::Merged, lo, hi - 1);
+}
+
+// Top-down merge sort of [lo, hi) that reuses one scratch buffer for every merge
+template <class RandomIt, class BufferIt, class Compare, class Ops>
+void bufferedMergeSortRange(RandomIt first, BufferIt buffer, ptrdiff_t lo, ptrdiff_t hi, Compare comp, Ops& ops) {
+    if (hi - lo < 2) return;
+    
+    ptrdiff_t mid = lo + (hi - lo) / 2;
+    ops.step(StepKind::Divide, lo, hi - 1, mid - 1);
+    bufferedMergeSortRange(first, buffer, lo, mid, comp, ops);
+    bufferedMergeSortRange(first, buffer, mid, hi, comp, ops);
+    mergeWithBuffer(first, buffer, lo, mid, hi, comp, ops);
+}
+
+// Top-down merge sort using caller-provided scratch space of at least last - first elements
+template <class RandomIt, class BufferIt, class Compare, class Ops>
+void bufferedMergeSort(RandomIt first, RandomIt last, BufferIt buffer, Compare comp, Ops& ops) {
+    bufferedMergeSortRange(first, buffer, 0, last - first, comp, ops);
+}
+
+// Top-down merge sort with a single scratch allocation per run
+template <class RandomIt, class Compare, class Ops>
+void bufferedMergeSort(RandomIt first, RandomIt last, Compare comp, Ops& ops) {
+    typedef typename iterator_traits<RandomIt>::value_type T;
+    vector<T> buffer(last - first);
+    ops.allocate(buffer.size() * sizeof(T));
+    bufferedMergeSort(first, last, buffer.begin(), comp, ops);
+}
+
+// Iterative merge sort: merges runs of width 1, 2, 4, ... through caller-provided scratch space
+template <class RandomIt, class BufferIt, class Compare, class Ops>
+void bottomUpMergeSort(RandomIt first, RandomIt last, BufferIt buffer, Compare comp, Ops& ops) {
+    ptrdiff_t n = last - first;
+    
+    for (ptrdiff_t width = 1; width < n; width *= 2) {
+        ops.step(StepKind::Pass, width, 0);
+        for (ptrdiff_t lo = 0; lo + width < n; lo += 2 * width) {
+            ptrdiff_t mid = lo + width;
+            ptrdiff_t hi = min(lo + 2 * width, n);
+            mergeWithBuffer(first, buffer, lo, mid, hi, comp, ops);
+        }
+    }
+}
+
+template <class RandomIt, class Compare, class Ops>
+void bottomUpMergeSort(RandomIt first, RandomIt last, Compare comp, Ops& ops) {
+    typedef typename iterator_traits<RandomIt>::value_type T;
+    vector<T> buffer(last - first);
+    ops.allocate(buffer.size() * sizeof(T));
+    bottomUpMergeSort(first, last, buffer.begin(), comp, ops);
+}
+
+// Exponential then binary search for the partition point of [base, base + n): the number
+// of leading elements that go before key. With after set, elements equal to key go before
+// it too. gallopFront probes from the front, gallopBack from the back; both cost O(log d)
+// comparisons for a partition point d elements from where they start.
+template <class It, class T, class Compare, class Ops>
+ptrdiff_t gallopFront(const T& key, It base, ptrdiff_t n, bool after, Compare comp, Ops& ops) {
+    ptrdiff_t known = 0, limit = n, probe = 0;
+    for (ptrdiff_t step = 1; probe < n; step *= 2) {
+        ops.compare(probe, probe);
+        if (after ? comp(key, base[probe]) : !comp(base[probe], key)) {
+            limit = probe;
+            break;
+        }
+        known = probe + 1;
+        probe += step;
+    }
+    while (known < limit) {
+        ptrdiff_t mid = known + (limit - known) / 2;
+        ops.compare(mid, mid);
+        if (after ? comp(key, base[mid]) : !comp(base[mid], key)) limit = mid; else known = mid + 1;
+    }
+    return known;
+}
+
+template <class It, class T, class Compare, class Ops>
+ptrdiff_t gallopBack(const T& key, It base, ptrdiff_t n, bool after, Compare comp, Ops& ops) {
+    ptrdiff_t known = 0, limit = n, probe = n - 1;
+    for (ptrdiff_t step = 1; probe >= 0; step *= 2) {
+        ops.compare(probe, probe);
+        if (!(after ? comp(key, base[probe]) : !comp(base[probe], key))) {
+            known = probe + 1;
+            break;
+        }
+        limit = probe;
+        probe -= step;
+    }
+    while (known < limit) {
+        ptrdiff_t mid = known + (limit - known) / 2;
+        ops.compare(mid, mid);
+        if (after ? comp(key, base[mid]) : !comp(base[mid], key)) limit = mid; else known = mid + 1;
+    }
+    return known;
+}
+
+// Consecutive wins of one side after which a merge switches to galloping
+const ptrdiff_t kMinGallop = 7;
+
+// Merges [lo, mid) and [mid, hi) front to back with the left run in the buffer. Elements
+// are taken one at a time until one side wins minGallop times in a row; then whole
+// stretches are found by galloping until both sides win less than kMinGallop at once.
+template <class RandomIt, class BufferIt, class Compare, class Ops>
+void mergeLowGalloping(RandomIt first, BufferIt buffer, ptrdiff_t lo, ptrdiff_t mid, ptrdiff_t hi,
+                       ptrdiff_t& minGallop, Compare comp, Ops& ops) {
+    std::move(first + lo, first + mid, buffer);
+    ops.bufferWrite(mid - lo);
+    
+    ptrdiff_t i = 0, n1 = mid - lo, j = mid, k = lo;
+    while (i < n1 && j < hi) {
+        ptrdiff_t leftWins = 0, rightWins = 0;
+        while (i < n1 && j < hi && max(leftWins, rightWins) < minGallop) {
+            ops.compare(j, lo + i);
+            if (comp(first[j], buffer[i])) {
+                first[k] = std::move(first[j++]);
+                ++rightWins;
+                leftWins = 0;
+            } else {
+                first[k] = std::move(buffer[i++]);
+                ++leftWins;
+                rightWins = 0;
+            }
+            ops.write(k++);
+        }
+        
+        while (i < n1 && j < hi) {
+            ptrdiff_t fromLeft = gallopFront(first[j], buffer + i, n1 - i, true, comp, ops);
+            for (ptrdiff_t c = 0; c < fromLeft; ++c) {
+                first[k] = std::move(buffer[i++]);
+                ops.write(k++);
+            }
+            if (i == n1) break;
+            ptrdiff_t fromRight = gallopFront(buffer[i], first + j, hi - j, false, comp, ops);
+            for (ptrdiff_t c = 0; c < fromRight; ++c) {
+                first[k] = std::move(first[j++]);
+                ops.write(k++);
+            }
+            if (fromLeft < kMinGallop && fromRight < kMinGallop) {
+                ++minGallop;
+                break;
+            }
+            if (minGallop > 1) --minGallop;
+        }
+    }
+    while (i < n1) {
+        first[k] = std::move(buffer[i++]);
+        ops.write(k++);
+    }
+}
+
+// Mirror of mergeLowGalloping for a shorter right run: it goes to the buffer and the
+// merge fills [lo, hi) back to front
+template <class RandomIt, class BufferIt, class Compare, class Ops>
+void mergeHighGalloping(RandomIt first, BufferIt buffer, ptrdiff_t lo, ptrdiff_t mid, ptrdiff_t hi,
+                        ptrdiff_t& minGallop, Compare comp, Ops& ops) {
+    std::move(first + mid, first + hi, buffer);
+    ops.bufferWrite(hi - mid);
+    
+    ptrdiff_t i = hi - mid - 1, j = mid - 1, k = hi - 1;
+    while (i >= 0 && j >= lo) {
+        ptrdiff_t leftWins = 0, rightWins = 0;
+        while (i >= 0 && j >= lo && max(leftWins, rightWins) < minGallop) {
+            ops.compare(mid + i, j);
+            if (comp(buffer[i], first[j])) {
+                first[k] = std::move(first[j--]);
+                ++leftWins;
+                rightWins = 0;
+            } else {
+                first[k] = std::move(buffer[i--]);
+                ++rightWins;
+                leftWins = 0;
+            }
+            ops.write(k--);
+        }
+        
+        while (i >= 0 && j >= lo) {
+            ptrdiff_t fromLeft = (j + 1 - lo) - gallopBack(buffer[i], first + lo, j + 1 - lo, true, comp, ops);
+            for (ptrdiff_t c = 0; c < fromLeft; ++c) {
+                first[k] = std::move(first[j--]);
+                ops.write(k--);
+            }
+            if (j < lo) break;
+            ptrdiff_t fromRight = (i + 1) - gallopBack(first[j], buffer, i + 1, false, comp, ops);
+            for (ptrdiff_t c = 0; c < fromRight; ++c) {
+                first[k] = std::move(buffer[i--]);
+                ops.write(k--);
+            }
+            if (fromLeft < kMinGallop && fromRight < kMinGallop) {
+                ++minGallop;
+                break;
+            }
+            if (minGallop > 1) --minGallop;
+        }
+    }
+    while (i >= 0) {
+        first[k] = std::move(buffer[i--]);
+        ops.write(k--);
+    }
+}
+
+// Merges adjacent runs [lo, mid) and [mid, hi). Prefixes and suffixes already in place are
+// found by galloping and skipped; the shorter remaining run goes to the buffer.
+template <class RandomIt, class BufferIt, class Compare, class Ops>
+void mergeRuns(RandomIt first, BufferIt buffer, ptrdiff_t lo, ptrdiff_t mid, ptrdiff_t hi,
+               ptrdiff_t& minGallop, Compare comp, Ops& ops) {
+    ops.step(StepKind::Merge, lo, hi - 1, mid - 1);
+    ptrdiff_t from = lo + gallopFront(first[mid], first + lo, mid - lo, true, comp, ops);
+    ptrdiff_t to = from < mid ? mid + gallopBack(first[mid - 1], first + mid, hi - mid, false, comp, ops) : mid;
+    
+    if (from < mid && mid < to) {
+        if (mid - from <= to - mid) {
+            mergeLowGalloping(first, buffer, from, mid, to, minGallop, comp, ops);
+        } else {
+            mergeHighGalloping(first, buffer, from, mid, to, minGallop, comp, ops);
+        }
+    }
+    ops.step(StepKind::Merged, lo, hi - 1);
+}
+
+// End of the natural run starting at lo. A strictly descending run is reversed in place,
+// which keeps equal keys in order; runs shorter than minRun are extended by insertion sort.
+template <class RandomIt, class Compare, class Ops>
+ptrdiff_t naturalRun(RandomIt first, ptrdiff_t lo, ptrdiff_t n, ptrdiff_t minRun, Compare comp, Ops& ops) {
+    ptrdiff_t hi = lo + 1;
+    if (hi < n) {
+        ops.compare(hi, lo);
+        if (comp(first[hi], first[lo])) {
+            while (++hi < n && (ops.compare(hi, hi - 1), comp(first[hi], first[hi - 1]))) {}
+            for (ptrdiff_t a = lo, b = hi - 1; a < b; ++a, --b) {
+                std::iter_swap(first + a, first + b);
+                ops.swap(a, b);
+            }
+        } else {
+            while (++hi < n && (ops.compare(hi, hi - 1), !comp(first[hi], first[hi - 1]))) {}
+        }
+    }
+    
+    if (hi - lo < minRun && hi < n) {
+        ptrdiff_t end = min(lo + minRun, n);
+        insertionSortRange(first, lo, end, comp, ops);
+        hi = end;
+    }
+    return hi;
+}
+
+// Depth of the boundary between runs [s1, s1 + n1) and [s1 + n1, s1 + n1 + n2) in the
+// nearly-optimal merge tree: the first bit in which the run midpoints, as fractions of n,
+// differ
+inline unsigned runBoundaryPower(ptrdiff_t s1, ptrdiff_t n1, ptrdiff_t n2, ptrdiff_t n) {
+    unsigned power = 0;
+    uint64_t a = 2 * s1 + n1, b = a + n1 + n2;
+    while (true) {
+        ++power;
+        if (a >= uint64_t(n)) {
+            a -= n;
+            b -= n;
+        } else if (b >= uint64_t(n)) {
+            break;
+        }
+        a <<= 1;
+        b <<= 1;
+    }
+    return power;
+}
+
+// Powersort (Munro & Wild): Timsort's natural runs and galloping merges, with merges
+// ordered by boundary powers so the merge cost stays within O(n + n·H) for run-length
+// entropy H ≤ log2(runs). Presorted input with few runs sorts in close to linear time.
+template <class RandomIt, class Compare, class Ops>
+void powerSort(RandomIt first, RandomIt last, Compare comp, Ops& ops) {
+    typedef typename iterator_traits<RandomIt>::value_type T;
+    struct Run {
+        ptrdiff_t start, end;
+        unsigned power;
+    };
+    const ptrdiff_t minRun = 24;
+    
+    ptrdiff_t n = last - first;
+    if (n < 2) return;
+    vector<T> buffer(n / 2 + 1);
+    ops.allocate(buffer.size() * sizeof(T));
+    ptrdiff_t minGallop = kMinGallop;
+    
+    vector<Run> stack;
+    Run current = {0, naturalRun(first, 0, n, minRun, comp, ops), 0};
+    while (current.end < n) {
+        Run next = {current.end, naturalRun(first, current.end, n, minRun, comp, ops), 0};
+        unsigned power = runBoundaryPower(current.start, current.end - current.start, next.end - next.start, n);
+        while (!stack.empty() && stack.back().power > power) {
+            mergeRuns(first, buffer.begin(), stack.back().start, current.start, current.end, minGallop, comp, ops);
+            current.start = stack.back().start;
+            stack.pop_back();
+        }
+        current.power = power;
+        stack.push_back(current);
+        current = next;
+    }
+    while (!stack.empty()) {
+        mergeRuns(first, buffer.begin(), stack.back().start, current.start, current.end, minGallop, comp, ops);
+        current.start = stack.back().start;
+        stack.pop_back();
+    }
+}
+
+template <class RandomIt, class BufferIt, class Compare, class Ops>
+void parallelMergeSortTask(RandomIt first, BufferIt buffer, ptrdiff_t lo, ptrdiff_t hi, Compare comp, Ops& ops,
+                           WorkStealingPool& pool, ptrdiff_t cutoff, mutex& opsLock) {
+    typename TaskOps<Ops>::type local;
+    
+    if (hi - lo <= cutoff) {
+        bufferedMergeSortRange(first, buffer, lo, hi, comp, local);
+    } else {
+        ptrdiff_t mid = lo + (hi - lo) / 2;
+        TaskGroup group(pool);
+        group.run([=, &ops, &pool, &opsLock]() {
+            parallelMergeSortTask(first, buffer, lo, mid, comp, ops, pool, cutoff, opsLock);
+        });
+        parallelMergeSortTask(first, buffer, mid, hi, comp, ops, pool, cutoff, opsLock);
+        group.wait();
+        mergeWithBuffer(first, buffer, lo, mid, hi, comp, local);
+    }
+    
+    absorb(ops, local, opsLock);
+}
+
+// Forks the two halves onto the pool; ranges up to cutoff are sorted sequentially
+template <class RandomIt, class Compare, class Ops>
+void parallelMergeSort(RandomIt first, RandomIt last, Compare comp, Ops& ops,
+                       WorkStealingPool& pool, ptrdiff_t cutoff) {
+    typedef typename iterator_traits<RandomIt>::value_type T;
+    vector<T> buffer(last - first);
+    ops.allocate(buffer.size() * sizeof(T));
+    
+    mutex opsLock;
+    parallelMergeSortTask(first, buffer.begin(), 0, last - first, comp, ops, pool, cutoff, opsLock);
+}
+
+template <class RandomIt, class Compare, class Ops>
+void parallelQuickSortTask(RandomIt first, ptrdiff_t lo, ptrdiff_t hi, int depthLimit, Compare comp, Ops& ops,
+                           WorkStealingPool& pool, ptrdiff_t cutoff, mutex& opsLock) {
+    typename TaskOps<Ops>::type local;
+    TaskGroup group(pool);
+    
+    while (hi - lo > cutoff && depthLimit-- > 0) {
+        selectPivot(first, lo, hi, comp, local);
+        ptrdiff_t lt, gt;
+        partitionThreeWay(first, lo, hi, comp, local, lt, gt);
+        
+        // Fork the smaller side and keep partitioning the larger one; keys equal to the
+        // pivot are already in place
+        ptrdiff_t forkLo = lo, forkHi = lt;
+        if (lt - lo < hi - gt) {
+            lo = gt;
+        } else {
+            forkLo = gt;
+            forkHi = hi;
+            hi = lt;
+        }
+        group.run([=, &ops, &pool, &opsLock]() {
+            parallelQuickSortTask(first, forkLo, forkHi, depthLimit, comp, ops, pool, cutoff, opsLock);
+        });
+    }
+    
+    // Ranges under the cutoff, and any that used up the depth budget, finish on introsort
+    introSort(first + lo, first + hi, comp, local);
+    group.wait();
+    absorb(ops, local, opsLock);
+}
+
+// Partitions three ways around a ninther pivot and forks the sides onto the pool
+template <class RandomIt, class Compare, class Ops>
+void parallelQuickSort(RandomIt first, RandomIt last, Compare comp, Ops& ops,
+                       WorkStealingPool& pool, ptrdiff_t cutoff) {
+    ptrdiff_t n = last - first;
+    int depthLimit = 0;
+    for (ptrdiff_t k = n; k > 1; k >>= 1) depthLimit += 2;
+    mutex opsLock;
+    parallelQuickSortTask(first, 0, n, depthLimit, comp, ops, pool, max<ptrdiff_t>(cutoff, kIntroInsertionCutoff), opsLock);
+}
+
+// Maps elements to unsigned keys whose natural order matches ascending element order
+struct RadixKey {
+    uint64_t operator()(int32_t v) const { return static_cast<uint32_t>(v) ^ 0x80000000u; }
+    uint64_t operator()(int64_t v) const { return static_cast<uint64_t>(v) ^ 0x8000000000000000ULL; }
+    uint64_t operator()(uint32_t v) const { return v; }
+    uint64_t operator()(uint64_t v) const { return v; }
+    uint64_t operator()(double v) const {
+        // IEEE 754: flip every bit of negatives, only the sign bit of positives
+        uint64_t bits;
+        memcpy(&bits, &v, sizeof(bits));
+        return (bits & 0x8000000000000000ULL) ? ~bits : bits ^ 0x8000000000000000ULL;
+    }
+    template <class R>
+    uint64_t operator()(const R& record) const { return record.key; }
+};
+
+// Number of low bits in which the keys of a range can differ
+inline unsigned significantBits(uint64_t lo, uint64_t hi) {
+    uint64_t diff = lo ^ hi;
+    unsigned bits = 0;
+    while (diff) {
+        ++bits;
+        diff >>= 1;
+    }
+    return bits;
+}
+
+// Key-range auto-detect: one read pass for the smallest and largest key
+template <class RandomIt, class Key>
+void keyRange(RandomIt first, ptrdiff_t n, Key key, uint64_t& lo, uint64_t& hi) {
+    lo = numeric_limits<uint64_t>::max();
+    hi = 0;
+    for (ptrdiff_t i = 0; i < n; ++i) {
+        uint64_t k = key(first[i]);
+        lo = min(lo, k);
+        hi = max(hi, k);
+    }
+}
+
+inline void prefetchForWrite(const void* address) {
+#if defined(__GNUC__)
+    __builtin_prefetch(address, 1);
+#else
+    (void)address;
+#endif
+}
+
+inline void prefetchForRead(const void* address) {
+#if defined(__GNUC__)
+    __builtin_prefetch(address, 0);
+#else
+    (void)address;
+#endif
+}
+
+// How many elements ahead the scatter loop prefetches its destination slot
+const ptrdiff_t kRadixPrefetchDistance = 16;
+
+// Stable scatter of src[0, n) into dst by the digit at shift; counts holds the bucket starts.
+// Writes land in the sorted range when toRange is set, in scratch space otherwise.
+template <class SrcIt, class DstIt, class Key, class Ops>
+void radixScatter(SrcIt src, DstIt dst, ptrdiff_t n, unsigned shift, uint64_t mask, size_t* counts,
+                  Key key, bool toRange, Ops& ops) {
+    ptrdiff_t i = 0;
+    for (; i + kRadixPrefetchDistance < n; ++i) {
+        size_t ahead = (key(src[i + kRadixPrefetchDistance]) >> shift) & mask;
+        prefetchForWrite(&dst[counts[ahead]]);
+        
+        size_t pos = counts[(key(src[i]) >> shift) & mask]++;
+        dst[pos] = std::move(src[i]);
+        if (toRange) ops.write(pos); else ops.bufferWrite(1);
+    }
+    for (; i < n; ++i) {
+        size_t pos = counts[(key(src[i]) >> shift) & mask]++;
+        dst[pos] = std::move(src[i]);
+        if (toRange) ops.write(pos); else ops.bufferWrite(1);
+    }
+}
+
+// Turns bucket sizes into bucket starts
+inline void exclusivePrefixSum(size_t* counts, size_t buckets) {
+    size_t sum = 0;
+    for (size_t b = 0; b < buckets; ++b) {
+        size_t size = counts[b];
+        counts[b] = sum;
+        sum += size;
+    }
+}
+
+// LSD radix sort with Bits-wide digits through caller-provided scratch space of last - first
+// elements. Only digits below the highest differing key bit are sorted, all of their
+// histograms come from a single read pass, and digits shared by every key are skipped.
+template <unsigned Bits, class RandomIt, class BufferIt, class Key, class Ops>
+void lsdRadixSort(RandomIt first, RandomIt last, BufferIt buffer, Key key, Ops& ops) {
+    const ptrdiff_t n = last - first;
+    if (n < 2) return;
+    
+    uint64_t lo, hi;
+    keyRange(first, n, key, lo, hi);
+    const unsigned passes = (significantBits(lo, hi) + Bits - 1) / Bits;
+    if (passes == 0) return;
+    
+    const size_t buckets = size_t(1) << Bits;
+    const uint64_t mask = buckets - 1;
+    vector<size_t> counts(passes * buckets, 0);
+    ops.allocate(counts.size() * sizeof(size_t));
+    
+    for (ptrdiff_t i = 0; i < n; ++i) {
+        uint64_t k = key(first[i]);
+        for (unsigned p = 0; p < passes; ++p) {
+            ++counts[p * buckets + ((k >> (p * Bits)) & mask)];
+        }
+    }
+    
+    bool inBuffer = false;
+    unsigned pass = 0;
+    for (unsigned p = 0; p < passes; ++p) {
+        size_t* c = &counts[p * buckets];
+        unsigned shift = p * Bits;
+        uint64_t firstDigit = ((inBuffer ? key(buffer[0]) : key(first[0])) >> shift) & mask;
+        if (c[firstDigit] == static_cast<size_t>(n)) continue;
+        
+        ops.step(StepKind::Digit, ++pass, shift, shift + Bits - 1);
+        exclusivePrefixSum(c, buckets);
+        if (inBuffer) {
+            radixScatter(buffer, first, n, shift, mask, c, key, true, ops);
+        } else {
+            radixScatter(first, buffer, n, shift, mask, c, key, false, ops);
+        }
+        inBuffer = !inBuffer;
+    }
+    
+    if (inBuffer) {
+        for (ptrdiff_t i = 0; i < n; ++i) {
+            first[i] = std::move(buffer[i]);
+            ops.write(i);
+        }
+    }
+}
+
+template <unsigned Bits, class RandomIt, class Key, class Ops>
+void lsdRadixSort(RandomIt first, RandomIt last, Key key, Ops& ops) {
+    typedef typename iterator_traits<RandomIt>::value_type T;
+    vector<T> buffer(last - first);
+    ops.allocate(buffer.size() * sizeof(T));
+    lsdRadixSort<Bits>(first, last, buffer.begin(), key, ops);
+}
+
+// Key ranges wider than this, and wider than twice the input, are left to radix sort
+const uint64_t kCountingSortMaxRange = uint64_t(1) << 16;
+
+// Stable counting sort over the detected key range through caller-provided scratch space
+template <class RandomIt, class BufferIt, class Key, class Ops>
+void countingSort(RandomIt first, RandomIt last, BufferIt buffer, Key key, Ops& ops) {
+    const ptrdiff_t n = last - first;
+    if (n < 2) return;
+    
+    uint64_t lo, hi;
+    keyRange(first, n, key, lo, hi);
+    uint64_t range = hi - lo;
+    if (range >= max<uint64_t>(kCountingSortMaxRange, 2 * static_cast<uint64_t>(n))) {
+        lsdRadixSort<16>(first, last, buffer, key, ops);
+        return;
+    }
+    
+    vector<size_t> counts(range + 1, 0);
+    ops.allocate(counts.size() * sizeof(size_t));
+    for (ptrdiff_t i = 0; i < n; ++i) {
+        ++counts[key(first[i]) - lo];
+    }
+    exclusivePrefixSum(counts.data(), counts.size());
+    
+    ops.step(StepKind::Digit, 1, 0, significantBits(0, range));
+    for (ptrdiff_t i = 0; i < n; ++i) {
+        buffer[counts[key(first[i]) - lo]++] = std::move(first[i]);
+        ops.bufferWrite(1);
+    }
+    for (ptrdiff_t i = 0; i < n; ++i) {
+        first[i] = std::move(buffer[i]);
+        ops.write(i);
+    }
+}
+
+template <class RandomIt, class Key, class Ops>
+void countingSort(RandomIt first, RandomIt last, Key key, Ops& ops) {
+    typedef typename iterator_traits<RandomIt>::value_type T;
+    vector<T> buffer(last - first);
+    ops.allocate(buffer.size() * sizeof(T));
+    countingSort(first, last, buffer.begin(), key, ops);
+}
+
+// Buckets at most this large are finished by insertion sort
+const ptrdiff_t kMsdInsertionCutoff = 32;
+
+// American flag sort of [lo, hi) on key bits [0, bits): permutes each bucket into place
+// by following swap cycles, then recurses into the buckets on the next 8 bits
+template <class RandomIt, class Key, class Ops>
+void americanFlagSortRange(RandomIt first, ptrdiff_t lo, ptrdiff_t hi, unsigned bits, Key key, Ops& ops) {
+    typedef typename iterator_traits<RandomIt>::value_type T;
+    
+    if (hi - lo <= kMsdInsertionCutoff) {
+        insertionSortRange(first, lo, hi, [&key](const T& a, const T& b) { return key(a) < key(b); }, ops);
+        return;
+    }
+    
+    while (bits > 0) {
+        const unsigned shift = bits > 8 ? bits - 8 : 0;
+        const uint64_t mask = (uint64_t(1) << (bits - shift)) - 1;
+        size_t counts[256] = {0};
+        for (ptrdiff_t i = lo; i < hi; ++i) {
+            ++counts[(key(first[i]) >> shift) & mask];
+        }
+        
+        // A digit shared by the whole range needs no permutation
+        if (counts[(key(first[lo]) >> shift) & mask] == static_cast<size_t>(hi - lo)) {
+            bits = shift;
+            continue;
+        }
+        
+        ops.step(StepKind::Bucket, lo, hi - 1, shift);
+        ptrdiff_t heads[256], tails[256];
+        ptrdiff_t start = lo;
+        for (size_t b = 0; b <= mask; ++b) {
+            heads[b] = start;
+            start += counts[b];
+            tails[b] = start;
+        }
+        
+        for (size_t b = 0; b <= mask; ++b) {
+            while (heads[b] < tails[b]) {
+                size_t d = (key(first[heads[b]]) >> shift) & mask;
+                if (d == b) {
+                    ++heads[b];
+                } else {
+                    swap(first[heads[b]], first[heads[d]]);
+                    ops.swap(heads[b], heads[d]);
+                    ++heads[d];
+                }
+            }
+        }
+        
+        ptrdiff_t bucketStart = lo;
+        for (size_t b = 0; b <= mask; ++b) {
+            if (counts[b] > 1 && shift > 0) {
+                americanFlagSortRange(first, bucketStart, bucketStart + counts[b], shift, key, ops);
+            }
+            bucketStart += counts[b];
+        }
+        return;
+    }
+}
+
+// In-place MSD radix sort with 8-bit digits, starting at the highest differing key bit
+template <class RandomIt, class Key, class Ops>
+void americanFlagSort(RandomIt first, RandomIt last, Key key, Ops& ops) {
+    const ptrdiff_t n = last - first;
+    if (n < 2) return;
+    
+    uint64_t lo, hi;
+    keyRange(first, n, key, lo, hi);
+    americanFlagSortRange(first, 0, n, significantBits(lo, hi), key, ops);
+}
+
+// Size bounds of the hybrid sort. Ranges up to networkLimit elements go to a sorting
+// network, up to insertionLimit to insertion sort, from radixLimit on to LSD radix sort
+// when its key order matches the comparator, and everything else to introsort.
+struct HybridThresholds {
+    size_t networkLimit = 16;
+    size_t insertionLimit = 32;
+    size_t radixLimit = 1 << 12;
+};
+
+// Networks pay off for keys that fit in a register; larger elements start at insertion sort
+template <class RandomIt, class Compare, class Ops>
+bool sortByNetwork(RandomIt first, RandomIt last, Compare comp, Ops& ops, true_type) {
+    networkSort(first, last, comp, ops);
+    return true;
+}
+
+template <class RandomIt, class Compare, class Ops>
+bool sortByNetwork(RandomIt, RandomIt, Compare, Ops&, false_type) {
+    return false;
+}
+
+// Whether sorting by RadixKey yields the order comp defines: std::less on the scalar types
+// RadixKey maps, and the record comparators that order by the same key
+template <class T>
+struct IsRadixScalar : integral_constant<bool,
+    is_same<T, int32_t>::value || is_same<T, int64_t>::value || is_same<T, uint32_t>::value ||
+    is_same<T, uint64_t>::value || is_same<T, double>::value> {};
+
+template <class T, class Compare>
+struct RadixOrdered : false_type {};
+
+template <class T>
+struct RadixOrdered<T, less<T> > : IsRadixScalar<T> {};
+
+// Radix sort only stands in for comparators it agrees with; others stay on introsort
+template <class RandomIt, class Ops>
+bool sortByRadix(RandomIt first, RandomIt last, Ops& ops, true_type) {
+    lsdRadixSort<8>(first, last, RadixKey(), ops);
+    return true;
+}
+
+template <class RandomIt, class Ops>
+bool sortByRadix(RandomIt, RandomIt, Ops&, false_type) {
+    return false;
+}
+
+// Routes a sort by its size to the algorithm that was fastest at that size on this machine
+template <class RandomIt, class Compare, class Ops>
+void hybridSort(RandomIt first, RandomIt last, Compare comp, Ops& ops, const HybridThresholds& limits) {
+    typedef typename iterator_traits<RandomIt>::value_type T;
+    size_t n = last - first;
+    if (n <= min(limits.networkLimit, kNetworkMax) &&
+        sortByNetwork(first, last, comp, ops, typename is_arithmetic<T>::type())) {
+        return;
+    } else if (n <= limits.insertionLimit) {
+        insertionSort(first, last, comp, ops);
+    } else if (n >= limits.radixLimit &&
+               sortByRadix(first, last, ops, typename RadixOrdered<T, Compare>::type())) {
+        return;
+    } else {
+        introSort(first, last, comp, ops);
+    }
+}
+
+// Runs f(part, lo, hi) on parts equal slices of [0, n) as pool tasks and waits for them
+template <class F>
+void forEachChunk(WorkStealingPool& pool, size_t n, size_t parts, F f) {
+    TaskGroup group(pool);
+    for (size_t p = 1; p < parts; ++p) {
+        group.run([=]() { f(p, n * p / parts, n * (p + 1) / parts); });
+    }
+    f(0, 0, n / parts);
+    group.wait();
+}
+
+// Scratch space for the bandwidth-bound parallel sorts. The memory is left untouched by the
+// allocating thread and first written chunk by chunk from pool tasks, so on a NUMA machine
+// its pages spread over the nodes of the workers instead of all landing on one node.
+template <class T>
+class FirstTouchBuffer {
+private:
+    T* elements;
+    size_t count;
+    
+public:
+    FirstTouchBuffer(size_t n, WorkStealingPool& pool, size_t parts)
+        : elements(static_cast<T*>(::operator new(n * sizeof(T)))), count(n) {
+        T* data = elements;
+        forEachChunk(pool, n, parts, [data](size_t, size_t lo, size_t hi) {
+            for (size_t i = lo; i < hi; ++i) new (data + i) T();
+        });
+    }
+    
+    ~FirstTouchBuffer() {
+        for (size_t i = 0; i < count; ++i) elements[i].~T();
+        ::operator delete(elements);
+    }
+    
+    FirstTouchBuffer(const FirstTouchBuffer&) = delete;
+    FirstTouchBuffer& operator=(const FirstTouchBuffer&) = delete;
+    
+    T* begin() { return elements; }
+    size_t size() const { return count; }
+};
+
+// Slices for a parallel pass over n elements: one per pool thread, none smaller than cutoff
+inline size_t chunkCount(WorkStealingPool& pool, ptrdiff_t n, ptrdiff_t cutoff) {
+    return static_cast<size_t>(min<ptrdiff_t>(pool.size(), max<ptrdiff_t>(1, n / max<ptrdiff_t>(1, cutoff))));
+}
+
+// Buckets per thread and samples per bucket of the parallel sample sort
+const size_t kSampleSortBucketsPerThread = 4;
+const size_t kSampleSortOversampling = 32;
+
+// Parallel sample sort: splitters from a sorted random sample cut the keys into buckets,
+// every thread classifies and scatters its own slice by per-thread bucket counts, and the
+// buckets are sorted as independent pool tasks. Keys equal to a splitter get a bucket of
+// their own that needs no sorting, so duplicate-heavy inputs still split evenly.
+template <class RandomIt, class Compare, class Ops>
+void parallelSampleSort(RandomIt first, RandomIt last, Compare comp, Ops& ops,
+                        WorkStealingPool& pool, ptrdiff_t cutoff) {
+    typedef typename iterator_traits<RandomIt>::value_type T;
+    typedef typename TaskOps<Ops>::type LocalOps;
+    const ptrdiff_t n = last - first;
+    const size_t parts = chunkCount(pool, n, cutoff);
+    if (parts < 2) {
+        introSort(first, last, comp, ops);
+        return;
+    }
+    
+    // Oversampled splitters at pseudo-random positions, so periodic inputs cannot fool them
+    const size_t targetBuckets = parts * kSampleSortBucketsPerThread;
+    vector<T> sample;
+    uint64_t state = static_cast<uint64_t>(n) * 0x9E3779B97F4A7C15ULL + 1;
+    for (size_t i = 0; i < targetBuckets * kSampleSortOversampling; ++i) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        sample.push_back(first[state % static_cast<uint64_t>(n)]);
+    }
+    ops.allocate(sample.size() * sizeof(T));
+    introSort(sample.begin(), sample.end(), comp, ops);
+    vector<T> splitters;
+    for (size_t b = 1; b < targetBuckets; ++b) {
+        const T& candidate = sample[b * kSampleSortOversampling - 1];
+        if (splitters.empty() || comp(splitters.back(), candidate)) splitters.push_back(candidate);
+    }
+    
+    // Bucket 2j holds the keys strictly between splitters j - 1 and j, bucket 2j - 1 the
+    // keys equal to splitter j - 1
+    const size_t buckets = 2 * splitters.size() + 1;
+    FirstTouchBuffer<T> buffer(n, pool, parts);
+    FirstTouchBuffer<uint16_t> oracle(n, pool, parts);
+    vector<size_t> counts(parts * buckets, 0);
+    ops.allocate(buffer.size() * sizeof(T) + oracle.size() * sizeof(uint16_t) + counts.size() * sizeof(size_t));
+    
+    mutex opsLock;
+    T* scratch = buffer.begin();
+    uint16_t* bucketOf = oracle.begin();
+    forEachChunk(pool, n, parts, [&, first](size_t part, size_t lo, size_t hi) {
+        LocalOps local;
+        size_t* c = &counts[part * buckets];
+        uint64_t comparisons = 0;
+        for (size_t i = lo; i < hi; ++i) {
+            size_t low = 0, high = splitters.size();
+            while (low < high) {
+                size_t mid = (low + high) / 2;
+                ++comparisons;
+                if (comp(first[i], splitters[mid])) high = mid; else low = mid + 1;
+            }
+            size_t b = 2 * low;
+            if (low > 0 && (++comparisons, !comp(splitters[low - 1], first[i]))) --b;
+            bucketOf[i] = static_cast<uint16_t>(b);
+            ++c[b];
+        }
+        local.vectorStep(comparisons, 0);
+        absorb(ops, local, opsLock);
+    });
+    
+    // Each thread writes its share of a bucket right after the shares of the threads before it
+    vector<size_t> bucketStart(buckets + 1, 0);
+    size_t sum = 0;
+    for (size_t b = 0; b < buckets; ++b) {
+        bucketStart[b] = sum;
+        for (size_t part = 0; part < parts; ++part) {
+            size_t size = counts[part * buckets + b];
+            counts[part * buckets + b] = sum;
+            sum += size;
+        }
+    }
+    bucketStart[buckets] = sum;
+    
+    forEachChunk(pool, n, parts, [&, first](size_t part, size_t lo, size_t hi) {
+        LocalOps local;
+        size_t* c = &counts[part * buckets];
+        for (size_t i = lo; i < hi; ++i) scratch[c[bucketOf[i]]++] = std::move(first[i]);
+        local.bufferWrite(hi - lo);
+        absorb(ops, local, opsLock);
+    });
+    
+    // Buckets move back and are sorted while their keys are still in cache; largest first
+    vector<size_t> order;
+    for (size_t b = 0; b < buckets; ++b) {
+        if (bucketStart[b + 1] > bucketStart[b]) order.push_back(b);
+    }
+    sort(order.begin(), order.end(), [&bucketStart](size_t a, size_t b) {
+        return bucketStart[a + 1] - bucketStart[a] > bucketStart[b + 1] - bucketStart[b];
+    });
+    TaskGroup group(pool);
+    for (size_t b : order) {
+        group.run([&, first, b]() {
+            LocalOps local;
+            size_t lo = bucketStart[b], hi = bucketStart[b + 1];
+            for (size_t i = lo; i < hi; ++i) {
+                first[i] = std::move(scratch[i]);
+                local.write(i);
+            }
+            if (b % 2 == 0) introSort(first + lo, first + hi, comp, local);
+            absorb(ops, local, opsLock);
+        });
+    }
+    group.wait();
+}
+
+// Parallel LSD radix sort with Bits-wide digits. Every pass counts the digits of each
+// thread's slice into its own histogram, turns the histograms into per-thread write
+// positions and lets each thread scatter its slice stably; digits shared by every key
+// are skipped.
+template <unsigned Bits, class RandomIt, class Key, class Ops>
+void parallelRadixSort(RandomIt first, RandomIt last, Key key, Ops& ops,
+                       WorkStealingPool& pool, ptrdiff_t cutoff) {
+    typedef typename iterator_traits<RandomIt>::value_type T;
+    typedef typename TaskOps<Ops>::type LocalOps;
+    const ptrdiff_t n = last - first;
+    const size_t parts = chunkCount(pool, n, cutoff);
+    if (parts < 2) {
+        lsdRadixSort<Bits>(first, last, key, ops);
+        return;
+    }
+    
+    vector<uint64_t> lows(parts), highs(parts);
+    forEachChunk(pool, n, parts, [&, first](size_t part, size_t lo, size_t hi) {
+        keyRange(first + lo, hi - lo, key, lows[part], highs[part]);
+    });
+    const uint64_t smallest = *min_element(lows.begin(), lows.end());
+    const uint64_t largest = *max_element(highs.begin(), highs.end());
+    const unsigned passes = (significantBits(smallest, largest) + Bits - 1) / Bits;
+    if (passes == 0) return;
+    
+    const size_t buckets = size_t(1) << Bits;
+    const uint64_t mask = buckets - 1;
+    FirstTouchBuffer<T> buffer(n, pool, parts);
+    vector<size_t> counts(parts * buckets);
+    ops.allocate(buffer.size() * sizeof(T) + counts.size() * sizeof(size_t));
+    
+    mutex opsLock;
+    T* scratch = buffer.begin();
+    bool inBuffer = false;
+    unsigned pass = 0;
+    for (unsigned p = 0; p < passes; ++p) {
+        const unsigned shift = p * Bits;
+        fill(counts.begin(), counts.end(), 0);
+        forEachChunk(pool, n, parts, [&, first](size_t part, size_t lo, size_t hi) {
+            size_t* c = &counts[part * buckets];
+            if (inBuffer) {
+                for (size_t i = lo; i < hi; ++i) ++c[(key(scratch[i]) >> shift) & mask];
+            } else {
+                for (size_t i = lo; i < hi; ++i) ++c[(key(first[i]) >> shift) & mask];
+            }
+        });
+        
+        // Bucket-major prefix sum: a thread's share of a digit follows the earlier threads' shares
+        size_t sum = 0;
+        bool single = false;
+        for (size_t b = 0; b < buckets; ++b) {
+            size_t start = sum;
+            for (size_t part = 0; part < parts; ++part) {
+                size_t size = counts[part * buckets + b];
+                counts[part * buckets + b] = sum;
+                sum += size;
+            }
+            if (sum - start == static_cast<size_t>(n)) single = true;
+        }
+        if (single) continue;
+        
+        ops.step(StepKind::Digit, ++pass, shift, shift + Bits - 1);
+        forEachChunk(pool, n, parts, [&, first](size_t part, size_t lo, size_t hi) {
+            LocalOps local;
+            size_t* c = &counts[part * buckets];
+            if (inBuffer) {
+                radixScatter(scratch + lo, first, hi - lo, shift, mask, c, key, true, local);
+            } else {
+                radixScatter(first + lo, scratch, hi - lo, shift, mask, c, key, false, local);
+            }
+            absorb(ops, local, opsLock);
+        });
+        inBuffer = !inBuffer;
+    }
+    
+    if (inBuffer) {
+        forEachChunk(pool, n, parts, [&, first](size_t, size_t lo, size_t hi) {
+            LocalOps local;
+            for (size_t i = lo; i < hi; ++i) {
+                first[i] = std::move(scratch[i]);
+                local.write(i);
+            }
+            absorb(ops, local, opsLock);
+        });
+    }
+}
+
+// Quicksort on the dispatched kernels: vectorized partition around a median-of-three key,
+// bitonic networks for ranges up to the kernel block size, heapsort past the depth limit
+template <class Ops>
+void vectorQuickSortRange(int* data, ptrdiff_t n, int depthLimit, const simd::SortKernels& kernels, Ops& ops) {
+    while (n > static_cast<ptrdiff_t>(kernels.blockSize)) {
+        if (depthLimit-- == 0) {
+            heapSortRange(data, 0, n, less<int>(), ops);
+            return;
+        }
+        
+        int pivot = data[medianOfThree(data, 0, n / 2, n - 1, less<int>(), ops)];
+        ptrdiff_t split = kernels.partition(data, n, pivot);
+        ops.vectorStep(n, n);
+        
+        if (split == 0) {
+            // The pivot is the smallest key: split off every copy of it instead
+            if (pivot == numeric_limits<int>::max()) return;
+            split = kernels.partition(data, n, pivot + 1);
+            ops.vectorStep(n, n);
+            data += split;
+            n -= split;
+            continue;
+        }
+        
+        // Recurse into the smaller side, loop on the larger one
+        if (split < n - split) {
+            vectorQuickSortRange(data, split, depthLimit, kernels, ops);
+            data += split;
+            n -= split;
+        } else {
+            vectorQuickSortRange(data + split, n - split, depthLimit, kernels, ops);
+            n = split;
+        }
+    }
+    ops.vectorStep(kernels.sortBlock(data, n), n);
+}
+
+// The kernels only cover int keys in ascending order; other element types use introsort
+template <class RandomIt, class Compare, class Ops>
+void vectorQuickSort(RandomIt first, RandomIt last, Compare comp, Ops& ops, const simd::SortKernels&) {
+    introSort(first, last, comp, ops);
+}
+
+template <class Ops>
+void vectorQuickSort(vector<int>::iterator first, vector<int>::iterator last, less<int>, Ops& ops,
+                     const simd::SortKernels& kernels) {
+    ptrdiff_t n = last - first;
+    int depthLimit = 0;
+    for (ptrdiff_t size = n; size > 1; size >>= 1) depthLimit += 2;
+    if (n > 1) vectorQuickSortRange(&*first, n, depthLimit, kernels, ops);
+}
+
+// Bottom-up merge sort on the dispatched kernels: networks sort blocks, then vectorized
+// merges double the run length, alternating between the data and a scratch buffer
+template <class Ops>
+void vectorMergeSortRuns(int* data, int* buffer, size_t n, const simd::SortKernels& kernels, Ops& ops) {
+    for (size_t lo = 0; lo < n; lo += kernels.blockSize) {
+        size_t count = min(kernels.blockSize, n - lo);
+        ops.vectorStep(kernels.sortBlock(data + lo, count), count);
+    }
+    
+    int* source = data;
+    int* target = buffer;
+    for (size_t width = kernels.blockSize; width < n; width *= 2) {
+        ops.step(StepKind::Pass, width, 0);
+        for (size_t lo = 0; lo < n; lo += 2 * width) {
+            size_t mid = min(lo + width, n), hi = min(lo + 2 * width, n);
+            uint64_t comparisons = kernels.merge(source + lo, mid - lo, source + mid, hi - mid, target + lo);
+            ops.vectorStep(comparisons, hi - lo);
+        }
+        swap(source, target);
+    }
+    
+    if (source != data) {
+        memcpy(data, source, n * sizeof(int));
+        ops.vectorStep(0, n);
+    }
+}
+
+template <class RandomIt, class Compare, class Ops>
+void vectorMergeSort(RandomIt first, RandomIt last, Compare comp, Ops& ops, const simd::SortKernels&) {
+    bufferedMergeSort(first, last, comp, ops);
+}
+
+template <class Ops>
+void vectorMergeSort(vector<int>::iterator first, vector<int>::iterator last, less<int>, Ops& ops,
+                     const simd::SortKernels& kernels) {
+    size_t n = last - first;
+    if (n < 2) return;
+    
+    vector<int> buffer(n);
+    ops.allocate(n * sizeof(int));
+    vectorMergeSortRuns(&*first, buffer.data(), n, kernels, ops);
+}
+
+// Linear search on the dispatched find kernel; other element types use the scalar loop
+template <class RandomIt, class T, class Compare, class Ops>
+RandomIt vectorLinearSearch(RandomIt first, RandomIt last, const T& target, Compare comp, Ops& ops,
+                            const simd::SearchKernels&) {
+    return linearSearch(first, last, target, comp, ops);
+}
+
+template <class Ops>
+const int* vectorLinearSearch(const int* first, const int* last, const int& target,
+                              less<int>, Ops& ops, const simd::SearchKernels& kernels) {
+    size_t n = last - first;
+    size_t found = n > 0 ? kernels.find(first, n, target) : 0;
+    // Reported like the scalar loop: one comparison per element up to the match
+    ops.vectorStep(found == n ? n : found + 1, 0);
+    return first + found;
+}
+
+template <class Ops>
+vector<int>::iterator vectorLinearSearch(vector<int>::iterator first, vector<int>::iterator last, const int& target,
+                                         less<int> comp, Ops& ops, const simd::SearchKernels& kernels) {
+    const int* keys = first == last ? nullptr : &*first;
+    return first + (vectorLinearSearch(keys, keys + (last - first), target, comp, ops, kernels) - keys);
+}
+
+} // namespace algorithms
+
+// Static search structures over int keys. Each is built once from sorted keys and then
+// answers lowerBound queries: the smallest key not below the target, or kNoKey.
+namespace lookup {
+
+const int kNoKey = numeric_limits<int>::max();
+
+// Queries the interleaved searches advance in lockstep; enough independent loads to
+// keep the memory system busy while each one waits for its own cache miss
+const size_t kInterleave = 16;
+
+// Int array whose first element starts a 64-byte cache line
+class AlignedInts {
+private:
+    vector<int> storage;
+    size_t offset = 0;
+    
+public:
+    AlignedInts() {}
+    AlignedInts(AlignedInts&&) = default;
+    AlignedInts& operator=(AlignedInts&&) = default;
+    // A copy would land at a different alignment
+    AlignedInts(const AlignedInts&) = delete;
+    AlignedInts& operator=(const AlignedInts&) = delete;
+    
+    void assign(size_t n, int value) {
+        const size_t lineInts = 64 / sizeof(int);
+        storage.assign(n + lineInts, value);
+        uintptr_t address = reinterpret_cast<uintptr_t>(storage.data());
+        offset = (64 - address % 64) % 64 / sizeof(int);
+    }
+    
+    int* data() { return storage.data() + offset; }
+    const int* data() const { return storage.data() + offset; }
+    size_t bytes() const { return storage.size() * sizeof(int); }
+};
+
+// Binary search whose only branch is the loop counter: the half to keep is picked with a
+// conditional move, and both possible next midpoints are prefetched
+class BranchlessBinary {
+private:
+    vector<int> keys;
+    
+public:
+    explicit BranchlessBinary(const vector<int>& sorted) : keys(sorted) {}
+    
+    int lowerBound(int target) const {
+        size_t len = keys.size();
+        if (len == 0) return kNoKey;
+        
+        const int* base = keys.data();
+        while (len > 1) {
+            size_t half = len / 2;
+            len -= half;
+            algorithms::prefetchForRead(base + len / 2 - 1);
+            algorithms::prefetchForRead(base + half + len / 2 - 1);
+            base = base[half - 1] < target ? base + half : base;
+        }
+        size_t pos = (base - keys.data()) + (*base < target);
+        return pos < keys.size() ? keys[pos] : kNoKey;
+    }
+    
+    // Answers count queries kInterleave at a time: every step of the loop advances each
+    // query of the group by one probe and prefetches that query's next probe
+    void lowerBoundBatch(const int* targets, size_t count, int* out) const {
+        const int* begin = keys.data();
+        for (size_t b = 0; b < count; b += kInterleave) {
+            size_t group = min(kInterleave, count - b);
+            if (keys.empty()) {
+                fill(out + b, out + b + group, kNoKey);
+                continue;
+            }
+            
+            const int* base[kInterleave];
+            for (size_t g = 0; g < group; ++g) base[g] = begin;
+            
+            size_t len = keys.size();
+            while (len > 1) {
+                size_t half = len / 2;
+                len -= half;
+                for (size_t g = 0; g < group; ++g) {
+                    base[g] = base[g][half - 1] < targets[b + g] ? base[g] + half : base[g];
+                    algorithms::prefetchForRead(base[g] + len / 2 - 1);
+                }
+            }
+            for (size_t g = 0; g < group; ++g) {
+                size_t pos = (base[g] - begin) + (*base[g] < targets[b + g]);
+                out[b + g] = pos < keys.size() ? keys[pos] : kNoKey;
+            }
+        }
+    }
+    
+    size_t bytes() const { return keys.size() * sizeof(int); }
+};
+
+// Keys in BFS order of an implicit binary tree (node k has children 2k and 2k + 1), so the
+// first levels of every search share a few cache lines. The search prefetches the line
+// holding the 16 descendants four levels down.
+class Eytzinger {
+private:
+    AlignedInts tree;       // 1-based; slot 0 is padding
+    size_t n;
+    unsigned fullLevels;    // levels every root-to-leaf path passes through
+    
+    size_t place(const vector<int>& sorted, size_t i, size_t k) {
+        if (k <= n) {
+            i = place(sorted, i, 2 * k);
+            tree.data()[k] = sorted[i++];
+            i = place(sorted, i, 2 * k + 1);
+        }
+        return i;
+    }
+    
+public:
+    explicit Eytzinger(const vector<int>& sorted) : n(sorted.size()), fullLevels(0) {
+        tree.assign(n + 1, kNoKey);
+        place(sorted, 0, 1);
+        while ((size_t(2) << fullLevels) - 1 <= n) ++fullLevels;
+    }
+    
+    int lowerBound(int target) const {
+        const int* t = tree.data();
+        size_t k = 1;
+        while (k <= n) {
+            // Prefetch hints never fault, so running past the end on the last levels is harmless
+            algorithms::prefetchForRead(reinterpret_cast<const char*>(t) + k * 16 * sizeof(int));
+            k = 2 * k + (t[k] < target);
+        }
+        // Undo the right turns taken after the last left turn; k = 0 means every key is smaller
+        k >>= __builtin_ffsll(~static_cast<long long>(k));
+        return k == 0 ? kNoKey : t[k];
+    }
+    
+    // Interleaved version of lowerBound. The full levels run unconditionally for the whole
+    // group; the partial last level is one conditional-move step that parks finished paths.
+    void lowerBoundBatch(const int* targets, size_t count, int* out) const {
+        const int* t = tree.data();
+        for (size_t b = 0; b < count; b += kInterleave) {
+            size_t group = min(kInterleave, count - b);
+            size_t k[kInterleave];
+            for (size_t g = 0; g < group; ++g) k[g] = 1;
+            
+            for (unsigned level = 0; level < fullLevels; ++level) {
+                for (size_t g = 0; g < group; ++g) {
+                    k[g] = 2 * k[g] + (t[k[g]] < targets[b + g]);
+                    algorithms::prefetchForRead(t + min(k[g], n));
+                }
+            }
+            for (size_t g = 0; g < group; ++g) {
+                bool inside = k[g] <= n;
+                size_t next = 2 * k[g] + (t[inside ? k[g] : 0] < targets[b + g]);
+                size_t last = inside ? next : k[g];
+                last >>= __builtin_ffsll(~static_cast<long long>(last));
+                out[b + g] = last == 0 ? kNoKey : t[last];
+            }
+        }
+    }
+    
+    size_t bytes() const { return tree.bytes(); }
+};
+
+// Static B-tree with one cache line of keys per node and kNodeKeys + 1 implicit children
+// (node k has children k * 17 + 1 .. k * 17 + 17). A node is searched with one SIMD rank.
+class STree {
+private:
+    static const size_t B = simd::kNodeKeys;
+    AlignedInts nodes;
+    size_t blocks;
+    const simd::SearchKernels* kernels;
+    
+    static size_t child(size_t k, size_t i) { return k * (B + 1) + i + 1; }
+    
+    size_t place(const vector<int>& sorted, size_t i, size_t k) {
+        if (k < blocks) {
+            for (size_t j = 0; j < B; ++j) {
+                i = place(sorted, i, child(k, j));
+                if (i < sorted.size()) nodes.data()[k * B + j] = sorted[i++];
+            }
+            i = place(sorted, i, child(k, B));
+        }
+        return i;
+    }
+    
+public:
+    STree(const vector<int>& sorted, const simd::SearchKernels& searchKernels)
+        : blocks((sorted.size() + B - 1) / B), kernels(&searchKernels) {
+        nodes.assign(blocks * B, kNoKey);
+        place(sorted, 0, 0);
+    }
+    
+    int lowerBound(int target) const {
+        const int* keys = nodes.data();
+        int result = kNoKey;
+        for (size_t k = 0; k < blocks;) {
+            unsigned i = kernels->nodeRank(keys + k * B, target);
+            if (i < B) result = keys[k * B + i];
+            k = child(k, i);
+        }
+        return result;
+    }
+    
+    size_t bytes() const { return nodes.bytes(); }
+};
+
+} // namespace lookup
+
+// Fixed-size record sorted by its key field, for measuring payload effects
+template <size_t Bytes>
+struct Record {
+    uint64_t key;
+    char payload[Bytes - sizeof(uint64_t)];
+    
+    Record() : key(0) {}
+    explicit Record(uint64_t k) : key(k) {
+        memset(payload, 0, sizeof(payload));
+    }
+};
+
+struct KeyLess {
+    template <class R>
+    bool operator()(const R& a, const R& b) const { return a.key < b.key; }
+};
+
+namespace algorithms {
+
+// KeyLess orders records by the key RadixKey sorts them by
+template <class R>
+struct RadixOrdered<R, KeyLess> : true_type {};
+
+} // namespace algorithms
+
+// Fast 64-bit generator; one instance per chunk keeps parallel generation deterministic
+struct SplitMix64 {
+    uint64_t state;
+    
+    explicit SplitMix64(uint64_t seed) : state(seed) {}
+    
+    uint64_t next() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+    
+    // Uniform double in [0, 1)
+    double uniform() {
+        return (next() >> 11) * (1.0 / 9007199254740992.0);
+    }
+    
+    // Uniform integer in [0, bound) for bound <= 2^32
+    uint64_t below(uint64_t bound) {
+        return ((next() >> 32) * bound) >> 32;
+    }
+};
+
+enum class Distribution {
+    Uniform, Sorted, Reverse, NearlySorted, OrganPipe, Sawtooth,
+    FewUnique, Zipf, Gaussian, QuicksortKiller
+};
+
+struct DistributionInfo {
+    Distribution id;
+    string name;
+    string description;
+    bool triggersWorstCase;     // long runs or heavy duplicates push naive-pivot sorts to O(n²)
+};
+
+// Shape parameters; every distribution reads only the ones it needs
+struct GeneratorParams {
+    int minVal = 1;
+    int maxVal = 100;
+    size_t swaps = 0;           // nearly-sorted: random swaps, 0 = n / 100
+    size_t teeth = 16;          // sawtooth: number of ascending runs
+    size_t uniqueValues = 8;    // few-unique: distinct keys
+    double zipfExponent = 1.0;
+};
+
+// Deterministic input generators. Element i depends only on the seed and the
+// 64K-element chunk containing it, so results are identical for any thread count.
+class InputGenerator {
+private:
+    static const size_t kChunk = 1 << 16;
+    static constexpr double kPi = 3.14159265358979323846;
+    
+    // Zipf ranks 1..n with P(k) ∝ k^-s via rejection-inversion (Hörmann & Derflinger)
+    class ZipfSampler {
+    private:
+        double n, s, hIntegralX1, hIntegralN, sFactor;
+        
+        static double helper1(double x) {
+            return fabs(x) > 1e-8 ? log1p(x) / x : 1.0 - x * (0.5 - x * (1.0 / 3.0 - 0.25 * x));
+        }
+        static double helper2(double x) {
+            return fabs(x) > 1e-8 ? expm1(x) / x : 1.0 + x * 0.5 * (1.0 + x / 3.0 * (1.0 + 0.25 * x));
+        }
+        double h(double x) const { return exp(-s * log(x)); }
+        double hIntegral(double x) const {
+            double logX = log(x);
+            return helper2((1.0 - s) * logX) * logX;
+        }
+        double hIntegralInverse(double x) const {
+            double t = max(-1.0, x * (1.0 - s));
+            return exp(helper1(t) * x);
+        }
+        
+    public:
+        ZipfSampler(uint64_t elements, double exponent) : n(static_cast<double>(elements)), s(exponent) {
+            hIntegralX1 = hIntegral(1.5) - 1.0;
+            hIntegralN = hIntegral(n + 0.5);
+            sFactor = 2.0 - hIntegralInverse(hIntegral(2.5) - h(2.0));
+        }
+        
+        uint64_t sample(SplitMix64& rng) const {
+            while (true) {
+                double u = hIntegralN + rng.uniform() * (hIntegralX1 - hIntegralN);
+                double x = hIntegralInverse(u);
+                double k = floor(x + 0.5);
+                if (k < 1.0) k = 1.0;
+                if (k > n) k = n;
+                if (k - x <= sFactor || u >= hIntegral(k + 0.5) - h(k)) {
+                    return static_cast<uint64_t>(k);
+                }
+            }
+        }
+    };
+    
+    // Calls fill(begin, end, rng) for every chunk, in parallel when a pool is given
+    template <class Fill>
+    static void forEachChunk(size_t n, uint64_t seed, WorkStealingPool* pool, Fill fill) {
+        size_t chunks = (n + kChunk - 1) / kChunk;
+        auto runChunk = [=, &fill](size_t c) {
+            SplitMix64 seeder(seed ^ (0xD1B54A32D192ED03ULL * (c + 1)));
+            SplitMix64 rng(seeder.next());
+            fill(c * kChunk, min(n, (c + 1) * kChunk), rng);
+        };
+        
+        if (!pool || pool->size() == 1 || chunks < 2) {
+            for (size_t c = 0; c < chunks; ++c) runChunk(c);
+            return;
+        }
+        
+        TaskGroup group(*pool);
+        for (size_t c = 0; c < chunks; ++c) {
+            group.run([=, &runChunk]() { runChunk(c); });
+        }
+        group.wait();
+    }
+    
+public:
+    static const vector<DistributionInfo>& distributions() {
+        static const vector<DistributionInfo> list = {
+            {Distribution::Uniform, "uniform", "uniform random values in [min, max]", false},
+            {Distribution::Sorted, "sorted", "ascending values spread over [min, max]", true},
+            {Distribution::Reverse, "reverse", "descending values spread over [min, max]", true},
+            {Distribution::NearlySorted, "nearly-sorted", "sorted, then k random swaps (--swaps)", true},
+            {Distribution::OrganPipe, "organ-pipe", "ascending first half, descending second half", true},
+            {Distribution::Sawtooth, "sawtooth", "k ascending runs (--teeth)", true},
+            {Distribution::FewUnique, "few-unique", "k distinct values in random order (--unique)", true},
+            {Distribution::Zipf, "zipf", "Zipf-distributed ranks over [min, max] (--zipf exponent)", true},
+            {Distribution::Gaussian, "gaussian", "normal around the range midpoint, stddev = range / 6", false},
+            {Distribution::QuicksortKiller, "killer", "median-of-three killer permutation of 1..n (Musser)", true}
+        };
+        return list;
+    }
+    
+    static const DistributionInfo& info(Distribution d) {
+        for (const DistributionInfo& entry : distributions()) {
+            if (entry.id == d) return entry;
+        }
+        return distributions().front();
+    }
+    
+    static bool parse(const string& name, Distribution& out) {
+        for (const DistributionInfo& entry : distributions()) {
+            if (entry.name == name) {
+                out = entry.id;
+                return true;
+            }
+        }
+        return false;
+    }
+    
+    static vector<int> generate(Distribution d, size_t n, uint64_t seed, const GeneratorParams& params,
+                                WorkStealingPool* pool = nullptr) {
+        vector<int> out(n);
+        if (n == 0) return out;
+        
+        int* data = out.data();
+        const int64_t minVal = params.minVal;
+        const uint64_t range = static_cast<uint64_t>(static_cast<int64_t>(params.maxVal) - minVal + 1);
+        // Position i of n spread evenly over the value range
+        auto spread = [=](size_t i) {
+            return static_cast<int>(minVal + static_cast<int64_t>(static_cast<double>(i) / n * range));
+        };
+        
+        switch (d) {
+            case Distribution::Uniform:
+                forEachChunk(n, seed, pool, [=](size_t b, size_t e, SplitMix64& rng) {
+                    for (size_t i = b; i < e; ++i) data[i] = static_cast<int>(minVal + rng.below(range));
+                });
+                break;
+                
+            case Distribution::Sorted:
+            case Distribution::NearlySorted:
+                forEachChunk(n, seed, pool, [=](size_t b, size_t e, SplitMix64&) {
+                    for (size_t i = b; i < e; ++i) data[i] = spread(i);
+                });
+                if (d == Distribution::NearlySorted) {
+                    SplitMix64 rng(seed);
+                    size_t swaps = params.swaps ? params.swaps : max<size_t>(1, n / 100);
+                    for (size_t s = 0; s < swaps; ++s) {
+                        swap(data[rng.below(n)], data[rng.below(n)]);
+                    }
+                }
+                break;
+                
+            case Distribution::Reverse:
+                forEachChunk(n, seed, pool, [=](size_t b, size_t e, SplitMix64&) {
+                    for (size_t i = b; i < e; ++i) data[i] = spread(n - 1 - i);
+                });
+                break;
+                
+            case Distribution::OrganPipe:
+                forEachChunk(n, seed, pool, [=](size_t b, size_t e, SplitMix64&) {
+                    for (size_t i = b; i < e; ++i) {
+                        size_t rank = i < n / 2 ? 2 * i : 2 * (n - 1 - i) + 1;
+                        data[i] = spread(min(rank, n - 1));
+                    }
+                });
+                break;
+                
+            case Distribution::Sawtooth: {
+                size_t period = max<size_t>(1, n / max<size_t>(1, params.teeth));
+                forEachChunk(n, seed, pool, [=](size_t b, size_t e, SplitMix64&) {
+                    for (size_t i = b; i < e; ++i) {
+                        data[i] = static_cast<int>(minVal + static_cast<int64_t>(
+                            static_cast<double>(i % period) / period * range));
+                    }
+                });
+                break;
+            }
+                
+            case Distribution::FewUnique: {
+                uint64_t unique = max<uint64_t>(1, min<uint64_t>(params.uniqueValues, range));
+                uint64_t stride = range / unique;
+                forEachChunk(n, seed, pool, [=](size_t b, size_t e, SplitMix64& rng) {
+                    for (size_t i = b; i < e; ++i) data[i] = static_cast<int>(minVal + rng.below(unique) * stride);
+                });
+                break;
+            }
+                
+            case Distribution::Zipf: {
+                ZipfSampler sampler(range, params.zipfExponent);
+                forEachChunk(n, seed, pool, [=](size_t b, size_t e, SplitMix64& rng) {
+                    for (size_t i = b; i < e; ++i) data[i] = static_cast<int>(minVal + sampler.sample(rng) - 1);
+                });
+                break;
+            }
+                
+            case Distribution::Gaussian: {
+                double mean = minVal + (range - 1) / 2.0;
+                double stddev = max(range / 6.0, 1e-9);
+                double lo = static_cast<double>(params.minVal), hi = static_cast<double>(params.maxVal);
+                forEachChunk(n, seed, pool, [=](size_t b, size_t e, SplitMix64& rng) {
+                    auto clampRound = [=](double value) {
+                        return static_cast<int>(floor(min(hi, max(lo, value)) + 0.5));
+                    };
+                    for (size_t i = b; i < e; i += 2) {
+                        // Box-Muller yields two samples per draw; 1 - uniform() keeps the logarithm finite
+                        double r = stddev * sqrt(-2.0 * log(1.0 - rng.uniform()));
+                        double theta = 2.0 * kPi * rng.uniform();
+                        data[i] = clampRound(mean + r * cos(theta));
+                        if (i + 1 < e) data[i + 1] = clampRound(mean + r * sin(theta));
+                    }
+                });
+                break;
+            }
+                
+            case Distribution::QuicksortKiller: {
+                // Musser's sequence: odd i in the first half pair i with k + i, the second half holds 2i.
+                // k must be even for this to be a permutation; the few leftover positions stay ascending.
+                size_t k = (n / 2) & ~static_cast<size_t>(1);
+                forEachChunk(n, seed, pool, [=](size_t b, size_t e, SplitMix64&) {
+                    for (size_t p = b; p < e; ++p) {
+                        size_t i = p + 1;
+                        if (p >= 2 * k) {
+                            data[p] = static_cast<int>(i);
+                        } else if (i > k) {
+                            data[p] = static_cast<int>(2 * (i - k));
+                        } else if (i % 2 == 1) {
+                            data[p] = static_cast<int>(i);
+                        } else {
+                            data[p] = static_cast<int>(k + i - 1);
+                        }
+                    }
+                });
+                break;
+            }
+        }
+        return out;
+    }
+};
+
+// Candidate growth model used when fitting measured timings
+struct ComplexityModel {
+    string name;
+    function<double(double)> growth;
+};
+
+// Result of fitting t(n) ≈ constant * growth(n) over a size sweep
+struct ComplexityFit {
+    string model;
+    double constant = 0.0;
+    double error = 0.0;     // RMS relative residual of the fit
+};
+
+const vector<ComplexityModel>& complexityModels() {
+    static const vector<ComplexityModel> models = {
+        {"O(1)",       [](double) { return 1.0; }},
+        {"O(log n)",   [](double n) { return log2(n); }},
+        {"O(n)",       [](double n) { return n; }},
+        {"O(n log n)", [](double n) { return n * log2(n); }},
+        {"O(n²)",      [](double n) { return n * n; }}
+    };
+    return models;
+}
+
+// Growth model of a complexity label. Counting and radix bounds grow like O(n) for a
+// fixed key range, so labels without a model of their own use O(n).
+const ComplexityModel& complexityModel(const string& name) {
+    const vector<ComplexityModel>& models = complexityModels();
+    for (const ComplexityModel& model : models) {
+        if (model.name == name) return model;
+    }
+    return models[2];
+}
+
+// Picks the model with the smallest relative least-squares error
+ComplexityFit fitComplexity(const vector<double>& sizes, const vector<double>& times) {
+    ComplexityFit best;
+    best.error = numeric_limits<double>::infinity();
+
+    for (const ComplexityModel& model : complexityModels()) {
+        // Minimizing sum(((t - c*f) / t)^2) gives c = sum(f/t) / sum((f/t)^2)
+        double num = 0.0, den = 0.0;
+        for (size_t i = 0; i < sizes.size(); ++i) {
+            if (times[i] <= 0.0) continue;
+            double ratio = model.growth(sizes[i]) / times[i];
+            num += ratio;
+            den += ratio * ratio;
+        }
+        if (den <= 0.0) continue;
+
+        double constant = num / den;
+        double sq = 0.0;
+        size_t count = 0;
+        for (size_t i = 0; i < sizes.size(); ++i) {
+            if (times[i] <= 0.0) continue;
+            double residual = (times[i] - constant * model.growth(sizes[i])) / times[i];
+            sq += residual * residual;
+            ++count;
+        }
+
+        double error = sqrt(sq / count);
+        if (error < best.error) {
+            best.model = model.name;
+            best.constant = constant;
+            best.error = error;
+        }
+    }
+    return best;
+}
+
+// How far an input already is from sorted order
+struct Presortedness {
+    size_t size = 0;
+    size_t runs = 0;                // maximal non-decreasing runs
+    size_t monotoneRuns = 0;        // runs when strictly descending stretches count as runs too
+    size_t longestRun = 0;
+    uint64_t inversions = 0;        // pairs i < j with a[i] > a[j]
+    size_t increasing = 0;          // longest non-decreasing subsequence
+};
+
+// Inversions of [first, last) counted during a merge sort of the keys in place
+inline uint64_t countInversions(int* first, int* last, int* buffer) {
+    ptrdiff_t n = last - first;
+    if (n < 2) return 0;
+    int* mid = first + n / 2;
+    uint64_t count = countInversions(first, mid, buffer) + countInversions(mid, last, buffer);
+    
+    int *i = first, *j = mid, *k = buffer;
+    while (i < mid && j < last) {
+        if (*j < *i) {
+            count += mid - i;
+            *k++ = *j++;
+        } else {
+            *k++ = *i++;
+        }
+    }
+    k = copy(i, mid, k);
+    copy(buffer, k, first);
+    return count;
+}
+
+// Runs in one pass, inversions by merge counting and the longest non-decreasing
+// subsequence by patience sorting; O(n log n) overall
+inline Presortedness measurePresortedness(const int* first, const int* last) {
+    Presortedness p;
+    p.size = last - first;
+    if (p.size == 0) return p;
+    
+    size_t start = 0;
+    for (size_t i = 1; i <= p.size; ++i) {
+        if (i == p.size || first[i] < first[i - 1]) {
+            ++p.runs;
+            p.longestRun = max(p.longestRun, i - start);
+            start = i;
+        }
+    }
+    for (size_t i = 0; i < p.size; ++p.monotoneRuns) {
+        size_t j = i + 1;
+        if (j < p.size && first[j] < first[i]) {
+            while (j < p.size && first[j] < first[j - 1]) ++j;
+        } else {
+            while (j < p.size && first[j] >= first[j - 1]) ++j;
+        }
+        i = j;
+    }
+    
+    vector<int> keys(first, last), buffer(p.size);
+    p.inversions = countInversions(keys.data(), keys.data() + keys.size(), buffer.data());
+    
+    vector<int> tails;
+    for (const int* it = first; it != last; ++it) {
+        vector<int>::iterator slot = upper_bound(tails.begin(), tails.end(), *it);
+        if (slot == tails.end()) tails.push_back(*it); else *slot = *it;
+    }
+    p.increasing = tails.size();
+    return p;
+}
+
+// Controls the input sizes and per-point effort of a size sweep
+struct SweepConfig {
+    int minExponent = 4;
+    int maxExponent = 20;
+    int quadraticLimit = 1 << 14;   // O(n²) algorithms are skipped above this size
+    Distribution distribution = Distribution::Uniform;
+    GeneratorParams params;
+    bool scaleRange = true;         // widen [min, max] to at least n values so duplicates don't dominate
+    BenchmarkConfig benchmark;
+
+    SweepConfig() {
+        benchmark.warmupRuns = 1;
+        benchmark.minRuns = 3;
+        benchmark.timeBudget = 0.1;
+        benchmark.targetRelativeError = 0.02;
+    }
+};
+
+// Median timings per algorithm over a geometric series of sizes
+struct SweepResult {
+    string distribution;
+    vector<int> sizes;
+    vector<vector<double>> medians;     // [algorithm][size index], negative when skipped
+    vector<ComplexityFit> fits;
+};
+
+// Per-query search latency over a geometric series of array sizes
+struct SearchLatencyResult {
+    vector<size_t> bytes;
+    vector<string> engines;
+    vector<vector<double>> latencies;       // [engine][size index], seconds, negative when skipped
+    size_t linearLimit = 16 << 20;          // linear scans are skipped above this array size
+};
+
+// Shape of a batch of search queries against the loaded array
+struct QueryBatchConfig {
+    size_t queries = 1 << 20;
+    double hitRatio = 0.5;                              // share of targets present in the array
+    Distribution distribution = Distribution::Uniform;  // which sorted positions the hits pick
+    size_t latencySamples = 1 << 16;                    // queries timed one group at a time
+};
+
+// Throughput and per-query latency of one search engine over a query batch
+struct QueryThroughput {
+    string engine;
+    double queriesPerSecond = 0.0;
+    double p50 = 0.0;
+    double p90 = 0.0;
+    double p99 = 0.0;
+    double p999 = 0.0;
+    double hitRatio = 0.0;      // measured share of queries that found their target
+};
+
+// Model name of the first CPU, "unknown" where /proc/cpuinfo has none
+inline string cpuModelName() {
+    ifstream cpuinfo("/proc/cpuinfo");
+    string line;
+    while (getline(cpuinfo, line)) {
+        if (line.compare(0, 10, "model name") == 0) {
+            size_t colon = line.find(':');
+            if (colon != string::npos) return line.substr(line.find_first_not_of(' ', colon + 1));
+            break;
+        }
+    }
+    return "unknown";
+}
+
+// Crossover measurements of a hybrid sort calibration, nanoseconds per sort
+struct HybridCalibration {
+    algorithms::HybridThresholds thresholds;
+    vector<size_t> smallSizes;
+    vector<double> networkTimes, insertionTimes;
+    vector<size_t> mediumSizes;
+    vector<double> insertionMediumTimes, introTimes;
+    vector<size_t> largeSizes;
+    vector<double> introLargeTimes, radixTimes;
+};
+
+// Finds the hybrid sort thresholds of this machine by timing the candidates head to head
+// on random keys, and keeps them in a small key=value file tied to the CPU model
+class HybridTuner {
+private:
+    // Best of several rounds of sorting every size-n chunk of a fixed random pool
+    template <class Sort>
+    static double nanosPerSort(size_t n, Sort sort) {
+        const size_t chunks = max<size_t>(1, (size_t(1) << 18) / n);
+        vector<int> pool(chunks * n), work(pool.size());
+        SplitMix64 rng(n);
+        for (int& key : pool) key = static_cast<int>(rng.next());
+        
+        double best = numeric_limits<double>::infinity();
+        for (int round = 0; round < 5; ++round) {
+            copy(pool.begin(), pool.end(), work.begin());
+            chrono::steady_clock::time_point start = chrono::steady_clock::now();
+            for (size_t c = 0; c < chunks; ++c) {
+                sort(work.begin() + c * n, work.begin() + (c + 1) * n);
+            }
+            best = min(best, chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / chunks);
+        }
+        return best;
+    }
+    
+public:
+    static HybridCalibration calibrate() {
+        typedef vector<int>::iterator It;
+        HybridCalibration result;
+        algorithms::HybridThresholds& limits = result.thresholds;
+        NullOps ops;
+        
+        limits.networkLimit = 1;
+        for (size_t n = 2; n <= algorithms::kNetworkMax; ++n) {
+            result.smallSizes.push_back(n);
+            result.networkTimes.push_back(nanosPerSort(n, [&ops](It f, It l) { algorithms::networkSort(f, l, less<int>(), ops); }));
+            result.insertionTimes.push_back(nanosPerSort(n, [&ops](It f, It l) { algorithms::insertionSort(f, l, less<int>(), ops); }));
+            if (result.networkTimes.back() < result.insertionTimes.back()) limits.networkLimit = n;
+        }
+        
+        limits.insertionLimit = limits.networkLimit;
+        for (size_t n = limits.networkLimit + 1; n <= 128; n += 4) {
+            result.mediumSizes.push_back(n);
+            result.insertionMediumTimes.push_back(nanosPerSort(n, [&ops](It f, It l) { algorithms::insertionSort(f, l, less<int>(), ops); }));
+            result.introTimes.push_back(nanosPerSort(n, [&ops](It f, It l) { algorithms::introSort(f, l, less<int>(), ops); }));
+            if (result.insertionMediumTimes.back() < result.introTimes.back()) limits.insertionLimit = n;
+        }
+        
+        // Radix sort takes over at the smallest size from which it wins every comparison
+        limits.radixLimit = numeric_limits<size_t>::max();
+        for (size_t n = 64; n <= (size_t(1) << 16); n *= 2) {
+            result.largeSizes.push_back(n);
+            result.introLargeTimes.push_back(nanosPerSort(n, [&ops](It f, It l) { algorithms::introSort(f, l, less<int>(), ops); }));
+            result.radixTimes.push_back(nanosPerSort(n, [&ops](It f, It l) {
+                algorithms::lsdRadixSort<8>(f, l, algorithms::RadixKey(), ops);
+            }));
+            bool radixWins = result.radixTimes.back() < result.introLargeTimes.back();
+            if (radixWins && limits.radixLimit == numeric_limits<size_t>::max()) limits.radixLimit = n;
+            if (!radixWins) limits.radixLimit = numeric_limits<size_t>::max();
+        }
+        // Ranges up to the insertion limit never reach the radix tier
+        if (limits.radixLimit <= limits.insertionLimit) limits.radixLimit = limits.insertionLimit + 1;
+        return result;
+    }
+    
+    // $HOME/.algorithm_analyzer.conf, or the working directory without a home
+    static string defaultPath() {
+        const char* home = getenv("HOME");
+        return string(home && *home ? home : ".") + "/.algorithm_analyzer.conf";
+    }
+    
+    static bool save(const string& path, const algorithms::HybridThresholds& limits) {
+        ofstream out(path.c_str(), ios::trunc);
+        out << "# Hybrid sort thresholds from a calibration run; delete this file to go back to the defaults\n";
+        out << "cpu=" << cpuModelName() << "\n";
+        out << "network_limit=" << limits.networkLimit << "\n";
+        out << "insertion_limit=" << limits.insertionLimit << "\n";
+        out << "radix_limit=" << limits.radixLimit << "\n";
+        return static_cast<bool>(out);
+    }
+    
+    // Reads the thresholds of a calibration on this CPU; a missing file, unknown keys or a
+    // calibration on another CPU leave limits untouched and return false
+    static bool load(const string& path, algorithms::HybridThresholds& limits) {
+        ifstream in(path.c_str());
+        if (!in) return false;
+        
+        algorithms::HybridThresholds loaded;
+        string line, cpu;
+        try {
+            while (getline(in, line)) {
+                if (line.empty() || line[0] == '#') continue;
+                size_t eq = line.find('=');
+                if (eq == string::npos) return false;
+                string name = line.substr(0, eq), value = line.substr(eq + 1);
+                if (name == "cpu") cpu = value;
+                else if (name == "network_limit") loaded.networkLimit = stoull(value);
+                else if (name == "insertion_limit") loaded.insertionLimit = stoull(value);
+                else if (name == "radix_limit") loaded.radixLimit = stoull(value);
+                else return false;
+            }
+        } catch (const exception&) {
+            return false;
+        }
+        if (cpu != cpuModelName()) return false;
+        limits = loaded;
+        return true;
+    }
+};
+
+// Data cache sizes in bytes as reported by the C library, 0 when unknown
+struct CacheSizes {
+    size_t l1 = 0;
+    size_t l2 = 0;
+    size_t llc = 0;
+    
+    static CacheSizes detect() {
+        CacheSizes sizes;
+#if defined(__linux__) && defined(_SC_LEVEL1_DCACHE_SIZE)
+        sizes.l1 = max(0L, sysconf(_SC_LEVEL1_DCACHE_SIZE));
+        sizes.l2 = max(0L, sysconf(_SC_LEVEL2_CACHE_SIZE));
+        sizes.llc = max(0L, sysconf(_SC_LEVEL3_CACHE_SIZE));
+        if (sizes.llc == 0) sizes.llc = sizes.l2;
+#endif
+        return sizes;
+    }
+};
+
+// Advises the kernel to back [data, data + bytes) with transparent huge pages, or to keep
+// it on base pages. Only whole 2 MB pages inside the range are affected.
+inline bool adviseHugePages(void* data, size_t bytes, bool huge) {
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    const uintptr_t page = 2 << 20;
+    uintptr_t start = (reinterpret_cast<uintptr_t>(data) + page - 1) & ~(page - 1);
+    uintptr_t end = (reinterpret_cast<uintptr_t>(data) + bytes) & ~(page - 1);
+    if (end <= start) return false;
+    return madvise(reinterpret_cast<void*>(start), end - start, huge ? MADV_HUGEPAGE : MADV_NOHUGEPAGE) == 0;
+#else
+    (void)data;
+    (void)bytes;
+    (void)huge;
+    return false;
+#endif
+}
+
+// Fresh anonymous memory for one probe, aligned to 2 MB so the page size of the whole
+// buffer is under control: huge pages when asked for, base pages otherwise
+class ProbeBuffer {
+private:
+    void* mapping = nullptr;
+    size_t mappedBytes = 0;
+    char* bytes = nullptr;
+    vector<char> fallback;
+    bool huge = false;
+    
+public:
+    ProbeBuffer(size_t size, bool hugePages) {
+        const size_t page = 2 << 20;
+        size_t rounded = (size + page - 1) / page * page;
+#ifdef __linux__
+        mappedBytes = rounded + page;
+        mapping = mmap(nullptr, mappedBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mapping == MAP_FAILED) throw bad_alloc();
+        bytes = reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(mapping) + page - 1) & ~uintptr_t(page - 1));
+        huge = adviseHugePages(bytes, rounded, hugePages) && hugePages;
+#else
+        (void)rounded;
+        (void)hugePages;
+        fallback.resize(size);
+        bytes = fallback.data();
+#endif
+    }
+    
+    ~ProbeBuffer() {
+#ifdef __linux__
+        if (mapping) munmap(mapping, mappedBytes);
+#endif
+    }
+    
+    ProbeBuffer(const ProbeBuffer&) = delete;
+    ProbeBuffer& operator=(const ProbeBuffer&) = delete;
+    
+    char* data() { return bytes; }
+    bool hugePages() const { return huge; }
+};
+
+// Load latency and read bandwidth over a geometric series of working sets
+struct MemoryProfile {
+    vector<size_t> bytes;
+    vector<double> latency;         // ns per dependent load on base pages
+    vector<double> hugeLatency;     // same on huge pages, empty when not measured
+    vector<double> bandwidth;       // bytes per second of a streaming read
+    vector<size_t> levels;          // measured capacity of each cache level, smallest first
+    bool hugeBacked = false;        // the kernel accepted the huge page advice
+};
+
+// Names and capacities of the cache levels, used to mark where a working set stops
+// fitting a level in the timing tables
+struct MemoryLevels {
+    vector<size_t> limits;
+    vector<string> names;
+    bool measured = false;
+    
+    static MemoryLevels reported(const CacheSizes& caches) {
+        MemoryLevels levels;
+        if (caches.l1) { levels.limits.push_back(caches.l1); levels.names.push_back("L1d"); }
+        if (caches.l2) { levels.limits.push_back(caches.l2); levels.names.push_back("L2"); }
+        if (caches.llc && caches.llc != caches.l2) { levels.limits.push_back(caches.llc); levels.names.push_back("LLC"); }
+        return levels;
+    }
+    
+    static MemoryLevels fromProfile(const MemoryProfile& profile) {
+        MemoryLevels levels;
+        levels.measured = true;
+        levels.limits = profile.levels;
+        for (size_t i = 0; i < profile.levels.size(); ++i) levels.names.push_back("L" + to_string(i + 1));
+        return levels;
+    }
+    
+    // The largest level that fits previous bytes but not bytes, empty when none
+    string crossed(size_t previous, size_t bytes) const {
+        for (size_t i = limits.size(); i-- > 0;) {
+            if (previous <= limits[i] && bytes > limits[i]) return names[i];
+        }
+        return string();
+    }
+    
+    // The smallest level that holds bytes, main memory when none does
+    string holding(size_t bytes) const {
+        for (size_t i = 0; i < limits.size(); ++i) {
+            if (bytes <= limits[i]) return names[i];
+        }
+        return "main memory";
+    }
+    
+    string describe() const {
+        if (limits.empty()) return "unknown";
+        string text;
+        for (size_t i = 0; i < limits.size(); ++i) {
+            text += (i ? ", " : "") + names[i] + " " + formatBytes(static_cast<double>(limits[i]));
+        }
+        return text + (measured ? " (measured)" : " (reported by the C library)");
+    }
+};
+
+// Measures the memory hierarchy directly: a pointer chase through a random cyclic
+// permutation of cache lines exposes load latency, a streaming sum the read bandwidth
+class MemoryProbe {
+private:
+    static const size_t kLine = 64;
+    static const size_t kChaseSteps = 1 << 20;
+    
+    // Keeps the probe results observable so the loops cannot be elided
+    static uint64_t& sink() {
+        static uint64_t value = 0;
+        return value;
+    }
+    
+    // Links the cache lines of the buffer into one random cycle and walks it
+    static double chaseLatency(ProbeBuffer& buffer, size_t bytes) {
+        size_t lines = bytes / kLine;
+        vector<size_t> order(lines);
+        for (size_t i = 0; i < lines; ++i) order[i] = i;
+        SplitMix64 rng(lines);
+        for (size_t i = lines - 1; i > 0; --i) std::swap(order[i], order[rng.below(i + 1)]);
+        char* base = buffer.data();
+        for (size_t i = 0; i < lines; ++i) {
+            *reinterpret_cast<void**>(base + order[i] * kLine) = base + order[(i + 1) % lines] * kLine;
+        }
+        
+        void* p = base + order[0] * kLine;
+        for (size_t s = 0; s < min(lines, kChaseSteps); ++s) p = *static_cast<void**>(p);
+        double best = numeric_limits<double>::infinity();
+        for (int round = 0; round < 3; ++round) {
+            chrono::steady_clock::time_point start = chrono::steady_clock::now();
+            for (size_t s = 0; s < kChaseSteps; ++s) p = *static_cast<void**>(p);
+            best = min(best, chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / kChaseSteps);
+        }
+        sink() += reinterpret_cast<uintptr_t>(p);
+        return best;
+    }
+    
+    // Sums the buffer with independent accumulators, repeated to at least 64 MB per round
+    static double streamBandwidth(ProbeBuffer& buffer, size_t bytes) {
+        const uint64_t* words = reinterpret_cast<const uint64_t*>(buffer.data());
+        size_t count = bytes / sizeof(uint64_t);
+        size_t passes = max<size_t>(1, (size_t(64) << 20) / bytes);
+        uint64_t total = 0;
+        double best = numeric_limits<double>::infinity();
+        for (int round = 0; round < 3; ++round) {
+            chrono::steady_clock::time_point start = chrono::steady_clock::now();
+            for (size_t pass = 0; pass < passes; ++pass) {
+                uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+                for (size_t i = 0; i + 4 <= count; i += 4) {
+                    s0 += words[i];
+                    s1 += words[i + 1];
+                    s2 += words[i + 2];
+                    s3 += words[i + 3];
+                }
+                total += s0 + s1 + s2 + s3;
+            }
+            best = min(best, chrono::duration<double>(chrono::steady_clock::now() - start).count());
+        }
+        sink() += total;
+        return static_cast<double>(bytes) * passes / best;
+    }
+    
+public:
+    // A level ends where latency climbs 30% above the current plateau. The climb is
+    // followed to the next plateau, and a step within twice the last level still belongs
+    // to it, so one gradual step is not counted twice.
+    static vector<size_t> findLevels(const vector<size_t>& bytes, const vector<double>& latency) {
+        vector<size_t> levels;
+        if (latency.empty()) return levels;
+        double plateau = latency[0];
+        for (size_t k = 1; k < latency.size(); ++k) {
+            if (latency[k] <= 1.3 * plateau) continue;
+            if (levels.empty() || bytes[k - 1] > 2 * levels.back()) levels.push_back(bytes[k - 1]);
+            while (k + 1 < latency.size() && latency[k + 1] > 1.1 * latency[k]) ++k;
+            plateau = latency[k];
+        }
+        return levels;
+    }
+    
+    // Four times the reported LLC, within 64 MB .. 512 MB so a misreported LLC stays cheap
+    static size_t defaultMaxBytes() {
+        return min<size_t>(size_t(512) << 20, max<size_t>(size_t(64) << 20, 4 * CacheSizes::detect().llc));
+    }
+    
+    // Working sets of 2^k and 1.5 * 2^k bytes from 4 KB up to maxBytes
+    static MemoryProfile measure(size_t maxBytes, bool hugePages) {
+        MemoryProfile profile;
+        for (size_t size = 4096; size <= maxBytes; size *= 2) {
+            profile.bytes.push_back(size);
+            if (size + size / 2 <= maxBytes) profile.bytes.push_back(size + size / 2);
+        }
+        profile.hugeBacked = hugePages;
+        for (size_t size : profile.bytes) {
+            cout << "Measuring " << formatBytes(static_cast<double>(size)) << "..." << flush;
+            {
+                ProbeBuffer buffer(size, false);
+                memset(buffer.data(), 1, size);
+                profile.bandwidth.push_back(streamBandwidth(buffer, size));
+                profile.latency.push_back(chaseLatency(buffer, size));
+            }
+            if (hugePages) {
+                ProbeBuffer buffer(size, true);
+                profile.hugeBacked = profile.hugeBacked && buffer.hugePages();
+                profile.hugeLatency.push_back(chaseLatency(buffer, size));
+            }
+            cout << " done" << endl;
+        }
+        // Huge pages take most TLB misses out of the curve, leaving the cache steps
+        profile.levels = findLevels(profile.bytes, hugePages ? profile.hugeLatency : profile.latency);
+        return profile;
+    }
+};
+
+const size_t MemoryProbe::kChaseSteps;
+
+// Tournament tree for k-way merging. Internal nodes keep the loser of their match, so
+// replacing the winner's key replays only the log2(k) matches on its path to the root.
+// Exhausted sources lose every match; equal keys go to the lower source, keeping the merge stable.
+class LoserTree {
+private:
+    vector<size_t> nodes;       // nodes[0] is the winner, nodes[1, k) the losers
+    vector<int> keys;
+    vector<bool> exhausted;
+    size_t k = 0;
+    
+    bool beats(size_t a, size_t b) const {
+        if (exhausted[a] || exhausted[b]) return !exhausted[a];
+        return keys[a] < keys[b] || (keys[a] == keys[b] && a < b);
+    }
+    
+    // Winner of the subtree at node; leaves sit at k .. 2k - 1
+    size_t play(size_t node) {
+        if (node >= k) return node - k;
+        size_t a = play(2 * node), b = play(2 * node + 1);
+        if (beats(a, b)) {
+            nodes[node] = b;
+            return a;
+        }
+        nodes[node] = a;
+        return b;
+    }
+    
+public:
+    // Sources without a first key are passed as exhausted
+    void build(const vector<int>& heads, const vector<bool>& empty) {
+        k = heads.size();
+        keys = heads;
+        exhausted = empty;
+        nodes.assign(max<size_t>(k, 1), 0);
+        if (k > 0) nodes[0] = play(1);
+    }
+    
+    bool done() const { return k == 0 || exhausted[nodes[0]]; }
+    size_t winner() const { return nodes[0]; }
+    int winnerKey() const { return keys[nodes[0]]; }
+    
+    // Gives the winning source its next key, or marks it exhausted, and replays its path
+    void replace(int key, bool empty) {
+        size_t source = nodes[0];
+        keys[source] = key;
+        exhausted[source] = empty;
+        for (size_t node = (source + k) / 2; node > 0; node /= 2) {
+            if (beats(nodes[node], source)) swap(nodes[node], source);
+        }
+        nodes[0] = source;
+    }
+};
+
+// Settings for sorting a file of raw native-endian int32 keys that may not fit in memory
+struct ExternalSortConfig {
+    string input;
+    string output;
+    size_t memoryBytes = size_t(256) << 20;    // shared by the run buffers, or the merge buffers
+};
+
+struct ExternalSortResult {
+    uint64_t keys = 0;
+    size_t runs = 0;
+    size_t runKeys = 0;
+    double runSeconds = 0.0;        // reading, sorting and writing the runs
+    double mergeSeconds = 0.0;
+    double totalSeconds = 0.0;
+    uint64_t bytesRead = 0;
+    uint64_t bytesWritten = 0;
+};
+
+// Two-phase external merge sort. Run formation rotates three buffers, so reading the next
+// run and writing the previous one overlap with sorting the current one. The merge phase
+// double-buffers every run and the output, refilling and flushing on background tasks.
+class ExternalSorter {
+private:
+    ExternalSortConfig config;
+    function<void(vector<int>&, size_t)> sortRun;    // sorts the first n keys of a buffer
+    string error;
+    
+    // Reads up to count keys into buffer; returns the number read
+    static size_t readKeys(istream& in, vector<int>& buffer, size_t count) {
+        buffer.resize(count);
+        in.read(reinterpret_cast<char*>(buffer.data()), count * sizeof(int));
+        return static_cast<size_t>(in.gcount()) / sizeof(int);
+    }
+    
+    static bool writeKeys(ostream& out, const vector<int>& buffer, size_t count) {
+        out.write(reinterpret_cast<const char*>(buffer.data()), count * sizeof(int));
+        return static_cast<bool>(out);
+    }
+    
+    string runPath(size_t run) const {
+        return config.output + ".run" + to_string(run);
+    }
+    
+    bool fail(const string& message) {
+        error = message;
+        return false;
+    }
+    
+    // Input and sorted runs share one background reader
+    struct RunReader {
+        ifstream file;
+        vector<int> block, spare;
+        size_t pos = 0;
+        size_t size = 0;
+        size_t blockKeys = 0;
+        uint64_t bytesRead = 0;
+        future<size_t> pending;
+        
+        void prefetch() {
+            pending = async(launch::async, [this]() { return readKeys(file, spare, blockKeys); });
+        }
+        
+        // Swaps in the block read in the background and starts reading the next; false at the end
+        bool refill() {
+            size = pending.get();
+            bytesRead += size * sizeof(int);
+            swap(block, spare);
+            pos = 0;
+            if (size > 0) prefetch();
+            return size > 0;
+        }
+    };
+    
+    bool formRuns(uint64_t keys, ExternalSortResult& result) {
+        ifstream in(config.input.c_str(), ios::binary);
+        if (!in) return fail("Cannot open input file: " + config.input);
+        
+        // Three run buffers: one being read, one sorted, one written
+        result.runKeys = max<size_t>(1024, config.memoryBytes / (3 * sizeof(int)));
+        bool singleRun = keys <= result.runKeys;
+        if (singleRun) result.runKeys = static_cast<size_t>(max<uint64_t>(keys, 1));
+        
+        vector<int> buffers[3];
+        size_t runKeys = result.runKeys;
+        future<size_t> reading = async(launch::async, [&]() { return readKeys(in, buffers[0], runKeys); });
+        future<bool> writing;
+        
+        for (size_t current = 0;; current = (current + 1) % 3) {
+            size_t count = reading.get();
+            if (count == 0) break;
+            result.bytesRead += count * sizeof(int);
+            
+            size_t next = (current + 1) % 3;
+            reading = async(launch::async, [&, next]() { return readKeys(in, buffers[next], runKeys); });
+            sortRun(buffers[current], count);
+            
+            if (writing.valid() && !writing.get()) return fail("Cannot write run file");
+            string path = singleRun ? config.output : runPath(result.runs);
+            writing = async(launch::async, [&, current, count, path]() {
+                ofstream out(path.c_str(), ios::binary | ios::trunc);
+                return out && writeKeys(out, buffers[current], count);
+            });
+            result.bytesWritten += count * sizeof(int);
+            ++result.runs;
+        }
+        if (writing.valid() && !writing.get()) return fail("Cannot write run file");
+        return true;
+    }
+    
+    bool mergeRuns(ExternalSortResult& result) {
+        size_t k = result.runs;
+        // Each run and the output hold two blocks at a time
+        size_t blockKeys = max<size_t>(4096, config.memoryBytes / (2 * (k + 1) * sizeof(int)));
+        
+        vector<unique_ptr<RunReader>> readers;
+        vector<int> heads(k, 0);
+        vector<bool> empty(k, true);
+        for (size_t r = 0; r < k; ++r) {
+            readers.push_back(unique_ptr<RunReader>(new RunReader));
+            RunReader& reader = *readers.back();
+            reader.file.open(runPath(r).c_str(), ios::binary);
+            if (!reader.file) return fail("Cannot open run file: " + runPath(r));
+            reader.blockKeys = blockKeys;
+            reader.prefetch();
+            if (reader.refill()) {
+                heads[r] = reader.block[reader.pos++];
+                empty[r] = false;
+            }
+        }
+        
+        ofstream out(config.output.c_str(), ios::binary | ios::trunc);
+        if (!out) return fail("Cannot open output file: " + config.output);
+        
+        LoserTree tree;
+        tree.build(heads, empty);
+        vector<int> outBlock(blockKeys), flushing(blockKeys);
+        size_t filled = 0;
+        future<bool> writing;
+        
+        while (!tree.done()) {
+            outBlock[filled++] = tree.winnerKey();
+            if (filled == blockKeys) {
+                if (writing.valid() && !writing.get()) return fail("Cannot write output file");
+                swap(outBlock, flushing);
+                writing = async(launch::async, [&out, &flushing, blockKeys]() { return writeKeys(out, flushing, blockKeys); });
+                result.bytesWritten += blockKeys * sizeof(int);
+                filled = 0;
+            }
+            
+            RunReader& reader = *readers[tree.winner()];
+            if (reader.pos == reader.size && !reader.refill()) {
+                tree.replace(0, true);
+            } else {
+                tree.replace(reader.block[reader.pos++], false);
+            }
+        }
+        
+        if (writing.valid() && !writing.get()) return fail("Cannot write output file");
+        if (!writeKeys(out, outBlock, filled)) return fail("Cannot write output file");
+        result.bytesWritten += filled * sizeof(int);
+        
+        for (size_t r = 0; r < k; ++r) {
+            result.bytesRead += readers[r]->bytesRead;
+            readers[r]->file.close();
+            remove(runPath(r).c_str());
+        }
+        return true;
+    }
+    
+public:
+    ExternalSorter(const ExternalSortConfig& cfg, function<void(vector<int>&, size_t)> sorter)
+        : config(cfg), sortRun(sorter) {}
+    
+    const string& lastError() const { return error; }
+    
+    bool run(ExternalSortResult& result) {
+        result = ExternalSortResult();
+        ifstream probe(config.input.c_str(), ios::binary | ios::ate);
+        if (!probe) return fail("Cannot open input file: " + config.input);
+        uint64_t bytes = static_cast<uint64_t>(probe.tellg());
+        probe.close();
+        if (bytes % sizeof(int) != 0) return fail("Input size is not a multiple of " + to_string(sizeof(int)) + " bytes");
+        result.keys = bytes / sizeof(int);
+        
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        if (!formRuns(result.keys, result)) return false;
+        chrono::steady_clock::time_point runsDone = chrono::steady_clock::now();
+        
+        if (result.runs == 0) {
+            ofstream out(config.output.c_str(), ios::binary | ios::trunc);
+            if (!out) return fail("Cannot open output file: " + config.output);
+        } else if (result.runs > 1 && !mergeRuns(result)) {
+            return false;
+        }
+        chrono::steady_clock::time_point end = chrono::steady_clock::now();
+        
+        result.runSeconds = chrono::duration<double>(runsDone - start).count();
+        result.mergeSeconds = chrono::duration<double>(end - runsDone).count();
+        result.totalSeconds = chrono::duration<double>(end - start).count();
+        return true;
+    }
+};
+
+// Header of a binary dataset file, followed by count native-endian keys. The version
+// field doubles as a byte-order mark: a file from a machine of the other endianness
+// shows a byte-swapped version and is rejected instead of being misread.
+struct DatasetHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t elementType;       // kInt32
+    uint64_t count;
+    uint64_t checksum;          // checksumKeys over the payload
+    uint64_t seed;              // generator seed, 0 when the keys were not generated
+    char distribution[24];      // generator name, NUL-padded
+    
+    static const uint32_t kVersion = 1;
+    static const uint32_t kInt32 = 1;
+};
+
+static_assert(sizeof(DatasetHeader) == 64, "dataset header layout must not depend on the compiler");
+
+// Multiplicative hash over 8-byte words in FNV-1a style, fast enough to verify 10^8 keys
+// on load. Feeding a payload in pieces gives the same result as hashing it in one call
+// as long as every piece but the last holds an even number of keys.
+inline uint64_t checksumKeys(const int* keys, size_t count, uint64_t hash = 0xCBF29CE484222325ULL) {
+    const uint64_t prime = 0x100000001B3ULL;
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        uint64_t word;
+        memcpy(&word, keys + i, sizeof(word));
+        hash = (hash ^ word) * prime;
+    }
+    if (i < count) hash = (hash ^ static_cast<uint32_t>(keys[i])) * prime;
+    return hash;
+}
+
+// Keys of a dataset file. Where mmap is available the keys are read straight from the
+// page cache without a copy; elsewhere they are read into memory.
+class MappedDataset {
+private:
+    DatasetHeader header;
+    const int* keys = nullptr;
+    vector<int> owned;
+    void* mapping = nullptr;
+    size_t mappedBytes = 0;
+    string error;
+    
+    bool fail(const string& message) {
+        close();
+        error = message;
+        return false;
+    }
+    
+    bool checkHeader(uint64_t fileBytes) {
+        if (fileBytes < sizeof(header) || memcmp(header.magic, "AADATA\0\0", 8) != 0) {
+            return fail("Not a dataset file");
+        }
+        if (header.version != DatasetHeader::kVersion) {
+            return fail("Unsupported dataset version or byte order");
+        }
+        if (header.elementType != DatasetHeader::kInt32) return fail("Unsupported element type");
+        if (fileBytes - sizeof(header) != header.count * sizeof(int)) return fail("Dataset size does not match its header");
+        return true;
+    }
+    
+public:
+    MappedDataset() { memset(&header, 0, sizeof(header)); }
+    ~MappedDataset() { close(); }
+    MappedDataset(const MappedDataset&) = delete;
+    MappedDataset& operator=(const MappedDataset&) = delete;
+    
+    bool open(const string& path) {
+        close();
+#ifdef __linux__
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return fail("Cannot open dataset: " + path);
+        struct stat info;
+        if (fstat(fd, &info) != 0 || ::read(fd, &header, sizeof(header)) != static_cast<ssize_t>(sizeof(header))) {
+            ::close(fd);
+            return fail("Not a dataset file");
+        }
+        if (!checkHeader(static_cast<uint64_t>(info.st_size))) {
+            ::close(fd);
+            return false;
+        }
+        if (header.count > 0) {
+            mappedBytes = static_cast<size_t>(info.st_size);
+            mapping = mmap(nullptr, mappedBytes, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping == MAP_FAILED) {
+                mapping = nullptr;
+                ::close(fd);
+                return fail("Cannot map dataset: " + path);
+            }
+            madvise(mapping, mappedBytes, MADV_SEQUENTIAL);
+            keys = reinterpret_cast<const int*>(static_cast<const char*>(mapping) + sizeof(header));
+        }
+        ::close(fd);
+#else
+        ifstream in(path.c_str(), ios::binary | ios::ate);
+        if (!in) return fail("Cannot open dataset: " + path);
+        uint64_t fileBytes = static_cast<uint64_t>(in.tellg());
+        in.seekg(0);
+        if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))) return fail("Not a dataset file");
+        if (!checkHeader(fileBytes)) return false;
+        owned.resize(header.count);
+        if (!in.read(reinterpret_cast<char*>(owned.data()), owned.size() * sizeof(int))) return fail("Cannot read dataset: " + path);
+        keys = owned.data();
+#endif
+        return true;
+    }
+    
+    void close() {
+#ifdef __linux__
+        if (mapping) munmap(mapping, mappedBytes);
+#endif
+        mapping = nullptr;
+        mappedBytes = 0;
+        owned.clear();
+        keys = nullptr;
+    }
+    
+    // Recomputes the payload checksum; touches every page once
+    bool verify() const {
+        return checksumKeys(keys, size()) == header.checksum;
+    }
+    
+    const int* begin() const { return keys; }
+    const int* end() const { return keys + size(); }
+    size_t size() const { return static_cast<size_t>(header.count); }
+    uint64_t seed() const { return header.seed; }
+    string distribution() const { return string(header.distribution, strnlen(header.distribution, sizeof(header.distribution))); }
+    const string& lastError() const { return error; }
+};
+
+// Writes dataset files, either from keys in memory or streamed from a text file
+class DatasetWriter {
+private:
+    static DatasetHeader makeHeader(uint64_t count, uint64_t checksum, uint64_t seed, const string& distribution) {
+        DatasetHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, "AADATA\0\0", 8);
+        header.version = DatasetHeader::kVersion;
+        header.elementType = DatasetHeader::kInt32;
+        header.count = count;
+        header.checksum = checksum;
+        header.seed = seed;
+        strncpy(header.distribution, distribution.c_str(), sizeof(header.distribution) - 1);
+        return header;
+    }
+    
+public:
+    static bool save(const string& path, const int* keys, size_t count, uint64_t seed, const string& distribution) {
+        ofstream out(path.c_str(), ios::binary | ios::trunc);
+        DatasetHeader header = makeHeader(count, checksumKeys(keys, count), seed, distribution);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(keys), count * sizeof(int));
+        return static_cast<bool>(out);
+    }
+    
+    // Converts integers separated by whitespace or commas to a dataset in fixed-size blocks,
+    // so the text never has to fit in memory. The header is patched once the count is known.
+    static bool importText(const string& textPath, const string& path, string& error) {
+        ifstream in(textPath.c_str());
+        if (!in) {
+            error = "Cannot open text file: " + textPath;
+            return false;
+        }
+        ofstream out(path.c_str(), ios::binary | ios::trunc);
+        if (!out) {
+            error = "Cannot write dataset: " + path;
+            return false;
+        }
+        DatasetHeader header = makeHeader(0, 0, 0, "imported");
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        
+        const size_t blockKeys = 1 << 20;      // even, so the block-wise checksum matches
+        vector<int> block;
+        block.reserve(blockKeys);
+        uint64_t count = 0, checksum = checksumKeys(nullptr, 0);
+        string token;
+        
+        while (true) {
+            bool more = static_cast<bool>(in >> token);
+            if (more) {
+                for (const string& item : splitCommas(token)) {
+                    size_t used = 0;
+                    long long value = 0;
+                    try {
+                        value = stoll(item, &used);
+                    } catch (const exception&) {
+                        used = 0;
+                    }
+                    if (used != item.size() || value < numeric_limits<int>::min() || value > numeric_limits<int>::max()) {
+                        error = "Not a 32-bit integer after " + to_string(count + block.size()) + " keys: " + item;
+                        out.close();
+                        remove(path.c_str());
+                        return false;
+                    }
+                    block.push_back(static_cast<int>(value));
+                }
+            }
+            if (block.size() >= blockKeys || (!more && !block.empty())) {
+                size_t whole = more ? blockKeys : block.size();
+                checksum = checksumKeys(block.data(), whole, checksum);
+                out.write(reinterpret_cast<const char*>(block.data()), whole * sizeof(int));
+                count += whole;
+                block.erase(block.begin(), block.begin() + whole);
+            }
+            if (!more) break;
+        }
+        
+        header.count = count;
+        header.checksum = checksum;
+        out.seekp(0);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.close();
+        if (!out) {
+            error = "Cannot write dataset: " + path;
+            remove(path.c_str());
+            return false;
+        }
+        return true;
+    }
+    
+private:
+    static vector<string> splitCommas(const string& token) {
+        vector<string> items;
+        size_t start = 0;
+        while (start <= token.size()) {
+            size_t comma = token.find(',', start);
+            if (comma == string::npos) comma = token.size();
+            if (comma > start) items.push_back(token.substr(start, comma - start));
+            start = comma + 1;
+        }
+        return items;
+    }
+};
+
+// Peak resident set size of this process. reset() lowers the high-water mark to the current
+// size (Linux 4.0+ through /proc/self/clear_refs), so a later peak covers a single run.
+class PeakMemory {
+public:
+    static bool reset() {
+#ifdef __linux__
+        ofstream refs("/proc/self/clear_refs");
+        refs << "5";
+        refs.close();
+        return static_cast<bool>(refs);
+#else
+        return false;
+#endif
+    }
+    
+    // High-water mark in bytes, 0 when unknown
+    static uint64_t peakBytes() {
+        ifstream status("/proc/self/status");
+        string line;
+        while (getline(status, line)) {
+            if (line.compare(0, 6, "VmHWM:") == 0) return strtoull(line.c_str() + 6, nullptr, 10) * 1024;
+        }
+        return 0;
+    }
+};
+
+// The keys every run starts from, and the buffers derived from them. Input keys are read
+// only: they live in an owned vector or straight in a mapped dataset file. Sorts work on
+// a separate buffer refilled before each run; searches share one sorted copy built on
+// first use. Setup happens here, so the timed regions only ever see prepared data.
+class DataArena {
+private:
+    vector<int> owned;
+    shared_ptr<MappedDataset> mapped;
+    const int* keys = nullptr;
+    size_t count = 0;
+    vector<int> working;
+    vector<int> sorted;
+    bool sortedValid = false;
+    bool hugePages = false;     // derived buffers are advised onto transparent huge pages
+    
+    // Allocates the buffer untouched, so the advice holds before the first page fault
+    void reserveBuffer(vector<int>& buffer) {
+        if (!hugePages || buffer.capacity() >= count) return;
+        buffer = vector<int>();
+        buffer.reserve(count);
+        adviseHugePages(buffer.data(), count * sizeof(int), true);
+    }
+    
+    void reset() {
+        working.clear();
+        working.shrink_to_fit();
+        sorted.clear();
+        sorted.shrink_to_fit();
+        sortedValid = false;
+    }
+    
+public:
+    DataArena() {}
+    
+    // Moving keeps the key pointer valid: the owned buffer changes hands, not address.
+    // The huge page setting stays with the arena that is moved from.
+    DataArena(DataArena&& other) : hugePages(other.hugePages) { *this = std::move(other); }
+    
+    DataArena& operator=(DataArena&& other) {
+        owned = std::move(other.owned);
+        mapped = std::move(other.mapped);
+        keys = other.keys;
+        count = other.count;
+        working = std::move(other.working);
+        sorted = std::move(other.sorted);
+        sortedValid = other.sortedValid;
+        other.keys = nullptr;
+        other.count = 0;
+        other.sortedValid = false;
+        return *this;
+    }
+    
+    void assign(vector<int>&& input) {
+        reset();
+        mapped.reset();
+        owned = std::move(input);
+        keys = owned.data();
+        count = owned.size();
+    }
+    
+    // Uses the mapped keys in place; the dataset stays open while the arena refers to it
+    void attach(const shared_ptr<MappedDataset>& dataset) {
+        reset();
+        owned = vector<int>();
+        mapped = dataset;
+        keys = dataset->begin();
+        count = dataset->size();
+    }
+    
+    const int* begin() const { return keys; }
+    const int* end() const { return keys + count; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    int operator[](size_t i) const { return keys[i]; }
+    bool isMapped() const { return static_cast<bool>(mapped); }
+    
+    void setHugePages(bool enabled) {
+        if (enabled != hugePages) reset();
+        hugePages = enabled;
+    }
+    
+    // Copies the input into the working buffer; its capacity is reused from run to run
+    vector<int>& refill() {
+        reserveBuffer(working);
+        working.assign(begin(), end());
+        return working;
+    }
+    
+    vector<int>& workingBuffer() { return working; }
+    
+    vector<int>& sortedView() {
+        if (!sortedValid) {
+            reserveBuffer(sorted);
+            sorted.assign(begin(), end());
+            sort(sorted.begin(), sorted.end());
+            sortedValid = true;
+        }
+        return sorted;
+    }
+    
+    uint64_t inputBytes() const { return count * sizeof(int); }
+    uint64_t workingBytes() const { return working.capacity() * sizeof(int); }
+    uint64_t sortedBytes() const { return sorted.capacity() * sizeof(int); }
+};
+
+// What a trace event stands for. Step events carry their StepKind in detail; Block marks a
+// vector kernel call that rearranged keys in bulk without reporting single positions.
+enum class TraceOp : uint8_t { Compare, Swap, Write, Step, Block, Keyframe };
+
+// One recorded operation. Positions are offsets into the traced range; value is the key a
+// Write stored. A Keyframe refers to a full snapshot of the keys at offset a of the store.
+struct TraceEvent {
+    TraceOp op;
+    uint8_t detail;
+    uint16_t reserved;
+    uint32_t a, b, c;
+    int32_t value;
+};
+
+static_assert(sizeof(TraceEvent) == 20, "trace events are written to disk as they are");
+
+// Header of a saved trace, followed by the first frame, the last frame, the keyframe store
+// and the events, oldest first
+struct TraceHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t eventSize;
+    uint64_t keyCount;          // keys in every frame
+    uint64_t eventCount;        // events in the file
+    uint64_t recorded;          // events recorded, including those folded into the first frame
+    uint64_t keyframeKeys;      // ints in the keyframe store
+    char algorithm[24];         // NUL-padded
+    
+    static const uint32_t kVersion = 1;
+};
+
+static_assert(sizeof(TraceHeader) == 72, "trace header layout must not depend on the compiler");
+
+// Step events of one visualized run in a fixed-size ring. Recording costs a store per
+// operation; when the ring is full the oldest event is folded into the first frame, so the
+// frame plus the retained events always replay to the keys the run produced.
+class TraceRecorder {
+private:
+    vector<TraceEvent> ring;
+    size_t capacity;
+    size_t head = 0;            // oldest retained event once the ring has wrapped
+    uint64_t recorded = 0;
+    vector<int> first;          // keys before the oldest retained event
+    vector<int> last;           // keys after the run
+    vector<int> keyframes;
+    size_t keyframeBudget;
+    string algorithm;
+    string error;
+    
+    void fold(const TraceEvent& event) {
+        switch (event.op) {
+            case TraceOp::Swap: std::swap(first[event.a], first[event.b]); break;
+            case TraceOp::Write: first[event.a] = event.value; break;
+            case TraceOp::Keyframe: copy(keyframes.begin() + event.a, keyframes.begin() + event.a + first.size(), first.begin()); break;
+            default: break;
+        }
+    }
+    
+    bool fail(const string& message) {
+        error = message;
+        return false;
+    }
+    
+public:
+    static const size_t kDefaultCapacity = 1 << 20;
+    
+    explicit TraceRecorder(size_t events = kDefaultCapacity, size_t keyframeKeys = 1 << 22)
+        : capacity(max<size_t>(events, 1)), keyframeBudget(keyframeKeys) {}
+    
+    void begin(const string& name, const vector<int>& keys) {
+        ring.clear();
+        head = 0;
+        recorded = 0;
+        first = keys;
+        last.clear();
+        keyframes.clear();
+        algorithm = name;
+    }
+    
+    void finish(const vector<int>& keys) { last = keys; }
+    
+    void record(TraceOp op, uint8_t detail, size_t a, size_t b, size_t c = 0, int value = 0) {
+        TraceEvent event = {op, detail, 0, static_cast<uint32_t>(a), static_cast<uint32_t>(b),
+                            static_cast<uint32_t>(c), value};
+        ++recorded;
+        if (ring.size() < capacity) {
+            ring.push_back(event);
+            return;
+        }
+        fold(ring[head]);
+        ring[head] = event;
+        if (++head == capacity) head = 0;
+    }
+    
+    // Snapshots the keys after a bulk update while the keyframe store has room
+    void keyframe(const vector<int>& keys) {
+        if (keyframes.size() + keys.size() > keyframeBudget) return;
+        size_t offset = keyframes.size();
+        keyframes.insert(keyframes.end(), keys.begin(), keys.end());
+        record(TraceOp::Keyframe, 0, offset, 0);
+    }
+    
+    size_t size() const { return ring.size(); }
+    bool empty() const { return ring.empty() && first.empty(); }
+    const TraceEvent& operator[](size_t i) const { return ring[(head + i) % ring.size()]; }
+    uint64_t folded() const { return recorded - ring.size(); }
+    const vector<int>& firstFrame() const { return first; }
+    const vector<int>& lastFrame() const { return last; }
+    const int* keyframeAt(uint32_t offset) const { return keyframes.data() + offset; }
+    const string& algorithmName() const { return algorithm; }
+    const string& lastError() const { return error; }
+    
+    bool save(const string& path) const {
+        ofstream out(path.c_str(), ios::binary | ios::trunc);
+        TraceHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, "AATRACE\0", sizeof(header.magic));
+        header.version = TraceHeader::kVersion;
+        header.eventSize = sizeof(TraceEvent);
+        header.keyCount = first.size();
+        header.eventCount = ring.size();
+        header.recorded = recorded;
+        header.keyframeKeys = keyframes.size();
+        strncpy(header.algorithm, algorithm.c_str(), sizeof(header.algorithm) - 1);
+        
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(first.data()), first.size() * sizeof(int));
+        out.write(reinterpret_cast<const char*>(last.data()), last.size() * sizeof(int));
+        out.write(reinterpret_cast<const char*>(keyframes.data()), keyframes.size() * sizeof(int));
+        for (size_t i = 0; i < ring.size(); ++i) {
+            out.write(reinterpret_cast<const char*>(&(*this)[i]), sizeof(TraceEvent));
+        }
+        return static_cast<bool>(out);
+    }
+    
+    // Replaces the trace with a saved one; events are checked so a damaged file cannot
+    // index outside its frames
+    bool load(const string& path) {
+        ifstream in(path.c_str(), ios::binary);
+        if (!in) return fail("Cannot open trace file: " + path);
+        TraceHeader header;
+        if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) || memcmp(header.magic, "AATRACE\0", 8) != 0) {
+            return fail("Not a trace file: " + path);
+        }
+        if (header.version != TraceHeader::kVersion || header.eventSize != sizeof(TraceEvent)) {
+            return fail("Unsupported trace version in " + path);
+        }
+        if (header.keyCount > numeric_limits<uint32_t>::max() || header.eventCount > header.recorded ||
+            header.keyframeKeys > (uint64_t(1) << 32)) {
+            return fail("Corrupt trace header in " + path);
+        }
+        
+        vector<int> firstKeys(header.keyCount), lastKeys(header.keyCount), store(header.keyframeKeys);
+        vector<TraceEvent> events;
+        bool ok = in.read(reinterpret_cast<char*>(firstKeys.data()), firstKeys.size() * sizeof(int)) &&
+                  in.read(reinterpret_cast<char*>(lastKeys.data()), lastKeys.size() * sizeof(int)) &&
+                  in.read(reinterpret_cast<char*>(store.data()), store.size() * sizeof(int));
+        for (uint64_t i = 0; ok && i < header.eventCount; ++i) {
+            TraceEvent event;
+            ok = static_cast<bool>(in.read(reinterpret_cast<char*>(&event), sizeof(event)));
+            bool positioned = event.op == TraceOp::Compare || event.op == TraceOp::Swap || event.op == TraceOp::Write;
+            if (ok && (event.op > TraceOp::Keyframe || (event.op == TraceOp::Step && event.detail > uint8_t(StepKind::Bucket)) ||
+                       (positioned && (event.a >= header.keyCount || event.b >= header.keyCount)) ||
+                       (event.op == TraceOp::Keyframe && event.a + header.keyCount > store.size()))) {
+                return fail("Corrupt trace event " + to_string(i) + " in " + path);
+            }
+            events.push_back(event);
+        }
+        if (!ok) return fail("Trace file is truncated: " + path);
+        
+        ring.swap(events);
+        capacity = max(capacity, ring.size());
+        head = 0;
+        recorded = header.recorded;
+        first.swap(firstKeys);
+        last.swap(lastKeys);
+        keyframes.swap(store);
+        algorithm = string(header.algorithm, strnlen(header.algorithm, sizeof(header.algorithm)));
+        return true;
+    }
+};
+
+struct ReplayConfig {
+    int delayMs = 300;          // pause after each shown frame
+    size_t fullLimit = 64;      // arrays up to this size show every step
+    size_t frames = 40;         // frames sampled from the trace of a larger array
+};
+
+// Plays a trace back on its own copy of the keys. Small arrays are shown step by step like
+// the algorithms narrate them; larger ones as evenly spaced frames with an order measure,
+// so output stays bounded whatever the size. Pauses sleep instead of spinning.
+class TraceRenderer {
+private:
+    vector<int> frame;
+    const TraceRecorder& trace;
+    ReplayConfig config;
+    int probe = 1;
+    bool merging = false;
+    
+    void pause() const {
+        if (config.delayMs > 0) this_thread::sleep_for(chrono::milliseconds(config.delayMs));
+    }
+    
+    int keyAt(size_t i) const { return i < frame.size() ? frame[i] : 0; }
+    
+    void show(size_t highlight, const string& label) const {
+        cout << label << ": [";
+        for (size_t i = 0; i < frame.size(); ++i) {
+            if (i == highlight) {
+                cout << ">" << frame[i] << "<";
+            } else {
+                cout << frame[i];
+            }
+            if (i < frame.size() - 1) cout << ", ";
+        }
+        cout << "]" << endl;
+    }
+    
+    void apply(const TraceEvent& event) {
+        switch (event.op) {
+            case TraceOp::Swap: std::swap(frame[event.a], frame[event.b]); break;
+            case TraceOp::Write: frame[event.a] = event.value; break;
+            case TraceOp::Keyframe: {
+                const int* keys = trace.keyframeAt(event.a);
+                copy(keys, keys + frame.size(), frame.begin());
+                break;
+            }
+            default: break;
+        }
+    }
+    
+    // Full mode: the same narration the algorithms gave when they printed inline
+    void narrate(const TraceEvent& event) {
+        size_t a = event.a, b = event.b, c = event.c;
+        switch (event.op) {
+            case TraceOp::Swap:
+                show(a, "Swapped " + to_string(a) + " and " + to_string(b));
+                pause();
+                return;
+            case TraceOp::Write:
+                if (merging) return;    // merges are shown once they complete
+                show(a, "Wrote position " + to_string(a));
+                pause();
+                return;
+            case TraceOp::Block:
+            case TraceOp::Keyframe:
+                show(frame.size(), "Vector kernel step");
+                pause();
+                return;
+            case TraceOp::Compare:
+                return;
+            case TraceOp::Step:
+                break;
+        }
+        
+        switch (static_cast<StepKind>(event.detail)) {
+            case StepKind::Visit:
+                show(a, "Step " + to_string(a + 1));
+                pause();
+                break;
+            case StepKind::Probe:
+                cout << "\nStep " << probe++ << ":" << endl;
+                cout << "Search range: indices " << a << " to " << b << endl;
+                cout << "Middle index: " << c << " → Value: " << keyAt(c) << endl;
+                pause();
+                break;
+            case StepKind::Pass:
+                cout << "\n--- Pass " << a << " ---" << endl;
+                break;
+            case StepKind::Scan:
+                cout << "\n--- Iteration " << a + 1 << " ---" << endl;
+                cout << "Finding minimum from index " << a << " to " << b << endl;
+                break;
+            case StepKind::Insert:
+                cout << "\nInserting element " << keyAt(a) << " at position " << a << endl;
+                break;
+            case StepKind::Partition:
+                cout << "\nPartitioning from " << a << " to " << b << " with pivot " << keyAt(b) << endl;
+                break;
+            case StepKind::PivotPlaced:
+                show(a, "Final pivot position");
+                pause();
+                break;
+            case StepKind::Divide:
+                cout << "\nDividing: [" << a << " - " << c << "] and [" << (c + 1) << " - " << b << "]" << endl;
+                break;
+            case StepKind::Merge:
+                cout << "Merging: [" << a << " - " << c << "] and [" << (c + 1) << " - " << b << "]" << endl;
+                merging = true;
+                break;
+            case StepKind::Merged:
+                merging = false;
+                show(frame.size(), "After merge");
+                pause();
+                break;
+            case StepKind::Digit:
+                cout << "\n--- Digit pass " << a << ": key bits " << b << " to " << c << " ---" << endl;
+                break;
+            case StepKind::Bucket:
+                cout << "\nDistributing [" << a << " - " << b << "] into buckets by key bits from " << c << endl;
+                break;
+        }
+    }
+    
+    // Sampled mode: the ends of the array and the share of adjacent pairs already in order
+    void sample(size_t events, uint64_t swaps, uint64_t writes, uint64_t compares) const {
+        const size_t edge = 8;
+        size_t ordered = 0;
+        for (size_t i = 1; i < frame.size(); ++i) ordered += frame[i - 1] <= frame[i];
+        double share = frame.size() > 1 ? 100.0 * ordered / (frame.size() - 1) : 100.0;
+        
+        ostringstream percent;
+        percent << fixed << setprecision(2) << share << "%";
+        cout << "Event " << setw(10) << right << events << "/" << left << setw(10) << trace.size() << right
+             << "  in order " << setw(7) << percent.str() << "  "
+             << compares << " cmp, " << swaps << " swp, " << writes << " wr  [";
+        for (size_t i = 0; i < frame.size(); ++i) {
+            if (i == edge && frame.size() > 2 * edge) {
+                cout << ", ...";
+                i = frame.size() - edge;
+            }
+            cout << (i ? ", " : "") << frame[i];
+        }
+        cout << "]" << endl;
+    }
+    
+public:
+    TraceRenderer(const TraceRecorder& recorded, const ReplayConfig& replay)
+        : frame(recorded.firstFrame()), trace(recorded), config(replay) {}
+    
+    void replay() {
+        if (trace.folded() > 0) {
+            cout << "(" << trace.folded() << " earlier events were folded into the first frame)" << endl;
+        }
+        
+        if (frame.size() <= config.fullLimit) {
+            for (size_t i = 0; i < trace.size(); ++i) {
+                apply(trace[i]);
+                narrate(trace[i]);
+            }
+        } else {
+            size_t frames = max<size_t>(config.frames, 1);
+            size_t stride = max<size_t>(1, (trace.size() + frames - 1) / frames);
+            uint64_t swaps = 0, writes = 0, compares = 0;
+            for (size_t i = 0; i < trace.size(); ++i) {
+                const TraceEvent& event = trace[i];
+                apply(event);
+                swaps += event.op == TraceOp::Swap;
+                writes += event.op == TraceOp::Write;
+                compares += event.op == TraceOp::Compare;
+                if ((i + 1) % stride == 0 || i + 1 == trace.size()) {
+                    sample(i + 1, swaps, writes, compares);
+                    pause();
+                }
+            }
+        }
+        
+        // Vector kernels rearrange keys without reporting them, so replayed frames can lag;
+        // the recorded result is authoritative
+        if (!trace.lastFrame().empty() && frame != trace.lastFrame()) {
+            frame = trace.lastFrame();
+            show(frame.size(), "Recorded result");
+        }
+    }
+};
+
+// One algorithm on one input, run by the JobScheduler. The input is generated from the
+// distribution, size and seed, or copied from shared keys when those are given.
+struct BenchmarkJob {
+    size_t algorithm = 0;
+    Distribution distribution = Distribution::Uniform;
+    string distributionName;
+    size_t size = 0;
+    uint64_t seed = 0;
+    GeneratorParams params;
+    shared_ptr<const vector<int>> keys;
+    double predicted = 0.0;         // seconds for the whole job, from a pilot run
+    bool skipped = false;           // predicted to run past the job timeout
+    int cpu = -1;                   // logical CPU the job ran on, -1 when not pinned
+    BenchmarkStats stats;
+    OperationCounts operations;
+};
+
+// How the JobScheduler spreads jobs over cores
+struct SchedulerConfig {
+    size_t workers = 1;             // concurrent jobs; 0 = one per physical core, 1 = serial
+    vector<int> cpus;               // CPUs to pin workers to, empty = one per physical core
+    double noiseTolerance = 0.10;   // probe slowdown under load that halves the workers
+};
+
+class AlgorithmVisualizer {
+private:
+    DataArena arena;
+    TraceRecorder trace;            // events of the last visualized run
+    ReplayConfig replayConfig;
+    
+    // Algorithm names for display
+    const vector<string> algorithmNames = {
+        "Linear Search", "Binary Search", "Bubble Sort", 
+        "Merge Sort", "Quick Sort", "Selection Sort", "Insertion Sort",
+        "Parallel Merge Sort", "Parallel Quick Sort",
+        "Merge Sort (Buffered)", "Merge Sort (Bottom-Up)", "Introsort",
+        "Counting Sort", "Radix Sort (LSD 8)", "Radix Sort (LSD 11)", "Radix Sort (LSD 16)",
+        "Radix Sort (MSD)", "Quick Sort (SIMD)", "Merge Sort (SIMD)", "Powersort",
+        "Hybrid Sort", "Parallel Sample Sort", "Parallel Radix Sort"
+    };
+    
+    // Pause between visualized steps, in milliseconds
+    const vector<int> algorithmDelays = {
+        500, 500, 300, 300, 200, 300, 300, 300, 200, 300, 300, 200,
+        300, 300, 300, 300, 200, 200, 300, 300, 300, 200, 300
+    };
+    
+    // Short identifiers accepted on the command line
+    const vector<string> algorithmKeys = {
+        "linear", "binary", "bubble", "merge", "quick", "selection", "insertion",
+        "pmerge", "pquick", "merge-buffered", "merge-bottomup", "introsort",
+        "counting", "radix8", "radix11", "radix16", "radix-msd", "quick-simd", "merge-simd",
+        "powersort", "hybrid", "psample", "pradix"
+    };
+    
+    // Theoretical complexity of each timed region, indexed like algorithmNames;
+    // k is the key range and d the number of digits the range spans
+    const vector<string> algorithmComplexities = {
+        "O(n)", "O(log n)", "O(n²)",
+        "O(n log n)", "O(n log n)", "O(n²)", "O(n²)",
+        "O(n log n)", "O(n log n)", "O(n log n)", "O(n log n)", "O(n log n)",
+        "O(n + k)", "O(d·n)", "O(d·n)", "O(d·n)", "O(d·n)", "O(n log n)", "O(n log n)",
+        "O(n log n)", "O(n log n)", "O(n log n)", "O(d·n)"
+    };
+    
+    // Worst-case complexity, reached by presorted or duplicate-heavy inputs
+    const vector<string> algorithmWorstCases = {
+        "O(n)", "O(log n)", "O(n²)",
+        "O(n log n)", "O(n²)", "O(n²)", "O(n²)",
+        "O(n log n)", "O(n log n)", "O(n log n)", "O(n log n)", "O(n log n)",
+        "O(d·n)", "O(d·n)", "O(d·n)", "O(d·n)", "O(d·n)", "O(n log n)", "O(n log n)",
+        "O(n log n)", "O(n log n)", "O(n log n)", "O(d·n)"
+    };
+    
+    vector<double> algorithmTimes;
+    vector<BenchmarkStats> algorithmStats;
+    BenchmarkEngine benchmark;
+    chrono::steady_clock::time_point timingStart;
+    unsigned seed = 0;
+    bool seeded = false;
+    PerfCounters perfCounters;
+    bool countersEnabled = false;
+    vector<OperationCounts> algorithmOperations;
+    vector<uint64_t> algorithmPeakMemory;    // process peak RSS of the counted run, 0 when unknown
+    vector<bool> algorithmSkipped;  // left out of the last comparison by the job timeout
+    double jobTimeout = 120.0;      // seconds per algorithm benchmark, 0 = unlimited
+    bool countOperations = false;
+    string distributionName = "custom";
+    uint64_t arraySeed = 0;         // generator seed of the loaded array, 0 when not generated
+    uint64_t generatorSeed = 0;     // seed of the most recent generateArray call
+    unique_ptr<WorkStealingPool> pool;
+    size_t threadCount = max(1u, thread::hardware_concurrency());
+    ptrdiff_t parallelCutoff = 4096;   // ranges at or below this size are sorted sequentially
+    const simd::SortKernels* sortKernels = &simd::kernelsFor(simd::bestLevel());
+    const simd::SearchKernels* searchKernels = &simd::searchKernelsFor(simd::bestLevel());
+    algorithms::HybridThresholds hybridLimits;
+    bool hybridCalibrated = false;  // hybridLimits come from a calibration on this CPU
+    MemoryProfile memoryProfile;    // empty until profileMemory runs
+    bool hugePages = false;         // benchmark buffers and memory probes use huge pages
+    
+    WorkStealingPool& workerPool() {
+        if (!pool || pool->size() != threadCount) {
+            pool.reset(new WorkStealingPool(threadCount));
+        }
+        return *pool;
+    }
+
+    // Marks the start of an algorithm's timed region
+    void beginTiming() {
+        if (countersEnabled) perfCounters.start();
+        timingStart = chrono::steady_clock::now();
+    }
+    
+    // Closes the timed region and records the elapsed seconds for the algorithm
+    double endTiming(size_t index) {
+        double timeTaken = chrono::duration<double>(chrono::steady_clock::now() - timingStart).count();
+        if (countersEnabled) perfCounters.stop();
+        algorithmTimes[index] = timeTaken;
+        return timeTaken;
+    }
+    
+    // Same as endTiming, and keeps the operation counts of a counted run
+    template <class Ops>
+    double endTiming(size_t index, const Ops& ops) {
+        double timeTaken = endTiming(index);
+        recordOperations(index, ops);
+        return timeTaken;
+    }
+    
+    void recordOperations(size_t, const NullOps&) {}
+    
+    void recordOperations(size_t index, const CountingOps& ops) {
+        algorithmOperations[index] = ops.counts;
+    }
+    
+    void displayOperations(size_t index) const {
+        const OperationCounts& ops = algorithmOperations[index];
+        cout << "Operations: " << ops.comparisons << " comparisons, " << ops.swaps << " swaps, "
+             << ops.writes << " writes, " << ops.allocations << " allocations ("
+             << ops.allocatedBytes << " bytes)" << endl;
+        cout << "Theoretical complexity: " << algorithmComplexities[index] << endl;
+    }
+
+public:
+    AlgorithmVisualizer()
+        : algorithmTimes(algorithmNames.size(), 0.0), algorithmStats(algorithmNames.size()),
+          algorithmOperations(algorithmNames.size()), algorithmPeakMemory(algorithmNames.size(), 0),
+          algorithmSkipped(algorithmNames.size(), false) {
+        hybridCalibrated = HybridTuner::load(HybridTuner::defaultPath(), hybridLimits);
+    }
+    
+    const vector<string>& getAlgorithmNames() const { return algorithmNames; }
+    const vector<string>& getAlgorithmKeys() const { return algorithmKeys; }
+    const vector<string>& getAlgorithmComplexities() const { return algorithmComplexities; }
+    const vector<BenchmarkStats>& getAlgorithmStats() const { return algorithmStats; }
+    const vector<OperationCounts>& getAlgorithmOperations() const { return algorithmOperations; }
+    const vector<uint64_t>& getAlgorithmPeakMemory() const { return algorithmPeakMemory; }
+    const DataArena& getInput() const { return arena; }
+    const TraceRecorder& getTrace() const { return trace; }
+    
+    void setReplayConfig(const ReplayConfig& config) { replayConfig = config; }
+    const ReplayConfig& getReplayConfig() const { return replayConfig; }
+    
+    // Records one run of an algorithm without showing it; searches look for the middle key
+    void recordTrace(size_t index) {
+        int target = arena.empty() ? 0 : arena[arena.size() / 2];
+        recordRun(index, index == 1 ? arena.sortedView() : arena.refill(), target);
+    }
+    
+    // Plays the last recorded or loaded trace at the configured pace
+    void replayTrace() const {
+        cout << "\n--- Replay: " << trace.algorithmName() << ", " << trace.firstFrame().size() << " elements, "
+             << trace.size() << " events ---" << endl;
+        TraceRenderer(trace, replayConfig).replay();
+    }
+    
+    bool saveTrace(const string& path) const { return trace.save(path); }
+    
+    bool loadTrace(const string& path) {
+        if (trace.load(path)) return true;
+        cout << trace.lastError() << endl;
+        return false;
+    }
+    
+    // The job timeout caps every benchmark as its time limit
+    void setBenchmarkConfig(const BenchmarkConfig& config) {
+        BenchmarkConfig limited = config;
+        limited.timeLimit = jobTimeout;
+        benchmark.setConfig(limited);
+    }
+    
+    // Benchmarks predicted to take longer are skipped; those that still overrun stop early
+    void setJobTimeout(double seconds) {
+        jobTimeout = max(0.0, seconds);
+        setBenchmarkConfig(benchmark.getConfig());
+    }
+    
+    double getJobTimeout() const { return jobTimeout; }
+    
+    // Gives a worker's visualizer the settings of this one. Counters count the thread that
+    // opens them, so this runs on the worker's own thread.
+    void copySettingsTo(AlgorithmVisualizer& other) const {
+        other.jobTimeout = jobTimeout;
+        other.setBenchmarkConfig(benchmark.getConfig());
+        other.sortKernels = sortKernels;
+        other.searchKernels = searchKernels;
+        other.threadCount = threadCount;
+        other.parallelCutoff = parallelCutoff;
+        other.hybridLimits = hybridLimits;
+        other.hybridCalibrated = hybridCalibrated;
+        other.memoryProfile = memoryProfile;
+        other.setHugePages(hugePages);
+        other.seed = seed;
+        other.seeded = seeded;
+        if (countersEnabled) other.setHardwareCounters(true);
+    }
+    
+    // Turns hardware counter collection on or off; returns whether any counter is usable
+    bool setHardwareCounters(bool enabled) {
+        countersEnabled = enabled && perfCounters.open();
+        if (!countersEnabled) perfCounters.close();
+        return countersEnabled;
+    }
+    
+    bool hardwareCountersEnabled() const { return countersEnabled; }
+    
+    // Threads used by the parallel sorts, including the calling thread
+    void setThreadCount(size_t threads) {
+        threadCount = max<size_t>(1, threads);
+    }
+    
+    size_t getThreadCount() const { return threadCount; }
+    
+    void setParallelCutoff(ptrdiff_t cutoff) {
+        parallelCutoff = max<ptrdiff_t>(1, cutoff);
+    }
+    
+    // Instruction set for the SIMD sorts and searches; unsupported levels fall back to the best available
+    void setSimdLevel(simd::Level level) {
+        sortKernels = &simd::kernelsFor(level);
+        searchKernels = &simd::searchKernelsFor(level);
+    }
+    
+    const simd::SortKernels& getSortKernels() const { return *sortKernels; }
+    const PerfCounters& getPerfCounters() const { return perfCounters; }
+    
+    void setArray(const vector<int>& arr, const string& distribution = "custom", uint64_t seed = 0) {
+        setArray(vector<int>(arr), distribution, seed);
+    }
+    
+    // Takes over the keys without copying them
+    void setArray(vector<int>&& arr, const string& distribution = "custom", uint64_t seed = 0) {
+        arena.assign(std::move(arr));
+        distributionName = distribution;
+        arraySeed = seed;
+    }
+    
+    // Loads the keys of a dataset file after checking its checksum
+    bool loadDataset(const string& path) {
+        shared_ptr<MappedDataset> dataset(new MappedDataset);
+        if (!dataset->open(path)) {
+            cout << dataset->lastError() << endl;
+            return false;
+        }
+        if (!dataset->verify()) {
+            cout << "Checksum mismatch: " << path << " is damaged" << endl;
+            return false;
+        }
+        string distribution = dataset->distribution();
+        arena.attach(dataset);
+        distributionName = distribution.empty() ? "custom" : distribution;
+        arraySeed = dataset->seed();
+        return true;
+    }
+    
+    // Saves the loaded array with its distribution name and generator seed
+    bool saveDataset(const string& path) const {
+        return DatasetWriter::save(path, arena.begin(), arena.size(), arraySeed, distributionName);
+    }
+    
+    uint64_t getArraySeed() const { return arraySeed; }
+    
+    const string& getDistributionName() const { return distributionName; }
+    
+    // True when an algorithm should not run at this size: O(n²) algorithms above the limit,
+    // and algorithms with an O(n²) worst case when the distribution triggers it
+    bool exceedsQuadraticLimit(size_t index, int size, int limit, const string& distribution) const {
+        if (limit <= 0 || size <= limit) return false;
+        return expectedGrowth(index, distribution) == "O(n²)";
+    }
+    
+    // Complexity an algorithm shows on a distribution: its worst case when the distribution triggers it
+    const string& expectedGrowth(size_t index, const string& distribution) const {
+        Distribution d;
+        bool triggers = InputGenerator::parse(distribution, d) && InputGenerator::info(d).triggersWorstCase;
+        return triggers ? algorithmWorstCases[index] : algorithmComplexities[index];
+    }
+    
+    // Algorithms that fan out over the worker pool and need the machine to themselves
+    bool usesWorkerPool(size_t index) const {
+        return index == 7 || index == 8 || index == 21 || index == 22;
+    }
+    
+    static const size_t kPilotKeys = 2048;
+    
+    // Seconds one run takes on n keys like the loaded ones, from pilot runs on the first
+    // kPilotKeys / 4 and kPilotKeys of them. The pilots can grow more gently than the
+    // expected complexity, as bubble or insertion sort do on presorted keys; the prediction
+    // follows the gentler of the two. Underestimates are caught by the benchmark time limit.
+    double predictRun(size_t index, size_t n) {
+        size_t m = min(arena.size(), kPilotKeys);
+        if (m < 8) return 0.0;
+        DataArena saved = std::move(arena);
+        vector<double> sizes = {static_cast<double>(m / 4), static_cast<double>(m)};
+        vector<double> times;
+        for (double size : sizes) {
+            arena.assign(vector<int>(saved.begin(), saved.begin() + static_cast<size_t>(size)));
+            double best = numeric_limits<double>::infinity();
+            for (int round = 0; round < 3; ++round) best = min(best, runAlgorithm(index));
+            times.push_back(best);
+        }
+        arena = std::move(saved);
+        
+        const ComplexityModel& expected = complexityModel(expectedGrowth(index, distributionName));
+        const ComplexityModel& fitted = complexityModel(fitComplexity(sizes, times).model);
+        double x = static_cast<double>(n);
+        return times[1] * min(expected.growth(x) / expected.growth(sizes[1]), fitted.growth(x) / fitted.growth(sizes[1]));
+    }
+    
+    // Seconds a benchmark of n keys takes at least: warm-ups, the minimum runs and the counted run
+    double predictJob(size_t index, size_t n) {
+        const BenchmarkConfig& config = benchmark.getConfig();
+        return predictRun(index, n) * (config.warmupRuns + max(1, config.minRuns) + 1);
+    }
+    
+    // Whether a benchmark of the loaded keys would run past the job timeout; small inputs
+    // are never predicted, their pilot would be the run itself
+    bool predictedOverrun(size_t index, double* predicted = nullptr) {
+        if (jobTimeout <= 0.0 || arena.size() <= kPilotKeys) return false;
+        double seconds = predictJob(index, arena.size());
+        if (predicted) *predicted = seconds;
+        return seconds > jobTimeout;
+    }
+    
+    void displayArray(const vector<int>& arr, const string& label = "") const {
+        displayArray(arr.data(), arr.data() + arr.size(), label);
+    }
+    
+    void displayArray(const int* first, const int* last, const string& label = "") const {
+        if (!label.empty()) {
+            cout << label << ": ";
+        }
+        
+        // Large arrays show only their ends
+        const size_t edge = 10;
+        size_t size = last - first;
+        bool truncated = size > 10 * edge;
+        
+        cout << "[";
+        for (size_t i = 0; i < size; ++i) {
+            if (truncated && i == edge) {
+                cout << "... " << size - 2 * edge << " more ..., ";
+                i = size - edge;
+            }
+            cout << first[i];
+            if (i < size - 1) cout << ", ";
+        }
+        cout << "]" << endl;
+    }
+    
+    // Enhanced Linear Search with step-by-step visualization
+    int linearSearch(int target, bool verbose = true) {
+        return execute(0, target, verbose);
+    }
+    
+    // Enhanced Binary Search
+    int binarySearch(int target, bool verbose = true) {
+        return execute(1, target, verbose);
+    }
+    
+    // Enhanced Bubble Sort with optimization
+    void bubbleSort(bool verbose = true) {
+        execute(2, 0, verbose);
+    }
+    
+    // Merge Sort implementation
+    void mergeSort(bool verbose = true) {
+        execute(3, 0, verbose);
+    }
+    
+    // Quick Sort implementation
+    void quickSort(bool verbose = true) {
+        execute(4, 0, verbose);
+    }
+    
+    // Enhanced Selection Sort
+    void selectionSort(bool verbose = true) {
+        execute(5, 0, verbose);
+    }
+    
+    // Enhanced Insertion Sort
+    void insertionSort(bool verbose = true) {
+        execute(6, 0, verbose);
+    }
+    
+    // Dispatches a sort by its index in algorithmNames over any element type
+    template <class RandomIt, class Compare, class Ops>
+    void sortRange(size_t index, RandomIt first, RandomIt last, Compare comp, Ops& ops) {
+        switch (index) {
+            case 2: algorithms::bubbleSort(first, last, comp, ops); break;
+            case 3: algorithms::mergeSort(first, last, comp, ops); break;
+            case 4: algorithms::quickSort(first, last, comp, ops); break;
+            case 5: algorithms::selectionSort(first, last, comp, ops); break;
+            case 6: algorithms::insertionSort(first, last, comp, ops); break;
+            case 7: algorithms::parallelMergeSort(first, last, comp, ops, workerPool(), parallelCutoff); break;
+            case 8: algorithms::parallelQuickSort(first, last, comp, ops, workerPool(), parallelCutoff); break;
+            case 9: algorithms::bufferedMergeSort(first, last, comp, ops); break;
+            case 10: algorithms::bottomUpMergeSort(first, last, comp, ops); break;
+            case 11: algorithms::introSort(first, last, comp, ops); break;
+            // Non-comparison sorts order by RadixKey, which matches the ascending comparators used here
+            case 12: algorithms::countingSort(first, last, algorithms::RadixKey(), ops); break;
+            case 13: algorithms::lsdRadixSort<8>(first, last, algorithms::RadixKey(), ops); break;
+            case 14: algorithms::lsdRadixSort<11>(first, last, algorithms::RadixKey(), ops); break;
+            case 15: algorithms::lsdRadixSort<16>(first, last, algorithms::RadixKey(), ops); break;
+            case 16: algorithms::americanFlagSort(first, last, algorithms::RadixKey(), ops); break;
+            case 17: algorithms::vectorQuickSort(first, last, comp, ops, *sortKernels); break;
+            case 18: algorithms::vectorMergeSort(first, last, comp, ops, *sortKernels); break;
+            case 19: algorithms::powerSort(first, last, comp, ops); break;
+            case 20: algorithms::hybridSort(first, last, comp, ops, hybridLimits); break;
+            case 21: algorithms::parallelSampleSort(first, last, comp, ops, workerPool(), parallelCutoff); break;
+            case 22: algorithms::parallelRadixSort<8>(first, last, algorithms::RadixKey(), ops, workerPool(), parallelCutoff); break;
+        }
+    }
+    
+private:
+    // Records every operation and step of a visualized run into the trace; also counts them
+    class VisualOps : public CountingOps {
+    private:
+        TraceRecorder& trace;
+        const vector<int>& array;
+        
+    public:
+        VisualOps(TraceRecorder& recorder, const vector<int>& arr) : trace(recorder), array(arr) {}
+        
+        void compare(size_t i, size_t j) {
+            CountingOps::compare(i, j);
+            trace.record(TraceOp::Compare, 0, i, j);
+        }
+        
+        void swap(size_t i, size_t j) {
+            CountingOps::swap(i, j);
+            trace.record(TraceOp::Swap, 0, i, j);
+        }
+        
+        void write(size_t i) {
+            CountingOps::write(i);
+            trace.record(TraceOp::Write, 0, i, 0, 0, array[i]);
+        }
+        
+        // Kernel calls move keys without naming them; a keyframe keeps the replay in step
+        void vectorStep(uint64_t comparisons, uint64_t writes) {
+            CountingOps::vectorStep(comparisons, writes);
+            if (writes == 0) return;
+            trace.record(TraceOp::Block, 0, 0, 0);
+            trace.keyframe(array);
+        }
+        
+        void step(StepKind kind, size_t a, size_t b, size_t c = 0) {
+            trace.record(TraceOp::Step, static_cast<uint8_t>(kind), a, b, c);
+        }
+    };
+    
+    static bool isSearch(size_t index) {
+        return index < 2;
+    }
+    
+    // Prepares the input, runs one algorithm under the matching policy and reports it. Setup
+    // stays outside the timed region: sorts get a fresh copy of the input, binary search the
+    // cached sorted view, and linear search reads the input where it lies.
+    int execute(size_t index, int target, bool verbose) {
+        vector<int>* keys = nullptr;
+        if (index == 1) {
+            keys = &arena.sortedView();
+        } else if (!isSearch(index) || verbose) {
+            keys = &arena.refill();
+        }
+        
+        if (verbose) {
+            cout << "\n--- " << algorithmNames[index] << " Process ---" << endl;
+            if (isSearch(index)) {
+                cout << "Searching for: " << target << endl;
+            }
+            if (index == 1) {
+                cout << "Sorted array: ";
+                displayArray(*keys);
+            } else if (!isSearch(index)) {
+                displayArray(*keys, "Original array");
+            }
+        }
+        
+        int result = -1;
+        if (verbose) {
+            result = recordRun(index, *keys, target);
+            ReplayConfig replay = replayConfig;
+            replay.delayMs = algorithmDelays[index];
+            TraceRenderer(trace, replay).replay();
+        } else if (countOperations) {
+            CountingOps ops;
+            result = dispatchRun(index, keys, target, ops);
+        } else {
+            NullOps ops;
+            result = dispatchRun(index, keys, target, ops);
+        }
+        
+        if (verbose) {
+            if (!isSearch(index)) {
+                cout << "\n✓ Sorting completed!" << endl;
+                displayArray(*keys, "Sorted array");
+            } else if (result >= 0) {
+                cout << "✓ Found at index: " << result << endl;
+            } else {
+                cout << "✗ Element not found" << endl;
+            }
+            cout << "Time taken: " << formatDuration(algorithmTimes[index]) << endl;
+            displayOperations(index);
+        }
+        return result;
+    }
+    
+    // Runs an algorithm on prepared keys with every operation going into the trace
+    int recordRun(size_t index, vector<int>& keys, int target) {
+        trace.begin(algorithmNames[index], keys);
+        VisualOps ops(trace, keys);
+        int result = dispatchRun(index, &keys, target, ops);
+        trace.finish(keys);
+        return result;
+    }
+    
+    // keys is the prepared buffer, or null when a search reads the input in place
+    template <class Ops>
+    int dispatchRun(size_t index, vector<int>* keys, int target, Ops& ops) {
+        if (!isSearch(index)) {
+            timedSort(index, *keys, ops);
+            return -1;
+        }
+        if (keys) return timedSearch(index, keys->begin(), keys->end(), target, ops);
+        return timedSearch(index, arena.begin(), arena.end(), target, ops);
+    }
+    
+    // The timed region of a search; returns the found index or -1
+    template <class RandomIt, class Ops>
+    int timedSearch(size_t index, RandomIt first, RandomIt last, int target, Ops& ops) {
+        RandomIt found = last;
+        beginTiming();
+        if (index == 0) {
+            found = linearSearchRange(first, last, target, ops);
+        } else {
+            found = algorithms::binarySearch(first, last, target, less<int>(), ops);
+        }
+        endTiming(index, ops);
+        return found == last ? -1 : static_cast<int>(found - first);
+    }
+    
+    // The timed region of a sort: nothing but the sort itself over the prepared copy
+    template <class Ops>
+    void timedSort(size_t index, vector<int>& keys, Ops& ops) {
+        beginTiming();
+        sortRange(index, keys.begin(), keys.end(), less<int>(), ops);
+        endTiming(index, ops);
+    }
+    
+    // Timed runs use the SIMD find kernel; visualized runs keep the scalar loop to show every visit
+    template <class RandomIt, class Ops>
+    RandomIt linearSearchRange(RandomIt first, RandomIt last, int target, Ops& ops) {
+        return algorithms::vectorLinearSearch(first, last, target, less<int>(), ops, *searchKernels);
+    }
+    
+    template <class RandomIt>
+    RandomIt linearSearchRange(RandomIt first, RandomIt last, int target, VisualOps& ops) {
+        return algorithms::linearSearch(first, last, target, less<int>(), ops);
+    }
+    
+    // Seconds per query when every query waits for the previous answer, so the time is the
+    // full latency of one lookup rather than the throughput of overlapping ones
+    template <class Lookup>
+    double queryLatency(Lookup lookup, const vector<int>& queries, const BenchmarkConfig& config) const {
+        BenchmarkEngine engine(config);
+        int last = 0;
+        BenchmarkStats stats = engine.run([&]() {
+            chrono::steady_clock::time_point start = chrono::steady_clock::now();
+            for (int query : queries) {
+                last = lookup(query ^ (last & 1));
+            }
+            return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        });
+        latencySink += last;
+        return stats.median / queries.size();
+    }
+    
+    mutable int latencySink = 0;    // keeps the query results observable
+    
+    // Hits are sorted keys at positions drawn from the configured distribution; misses are
+    // random values absent from the array, or values just outside it when the range is dense
+    vector<int> makeQueryTargets(const vector<int>& sorted, const QueryBatchConfig& config) {
+        vector<int> targets(config.queries);
+        if (sorted.empty()) return targets;
+        
+        GeneratorParams params;
+        params.minVal = 0;
+        params.maxVal = static_cast<int>(sorted.size() - 1);
+        vector<int> positions = generateArray(config.distribution, config.queries, params);
+        
+        SplitMix64 rng(seeded ? seed : 0x5EED);
+        const int64_t lo = sorted.front(), hi = sorted.back();
+        for (size_t i = 0; i < targets.size(); ++i) {
+            if (rng.uniform() < config.hitRatio) {
+                // Distributions that ignore the value range (killer) are clamped onto it
+                size_t position = min<size_t>(max(positions[i], 0), sorted.size() - 1);
+                targets[i] = sorted[position];
+                continue;
+            }
+            
+            int64_t miss = hi + 1 + static_cast<int64_t>(rng.below(sorted.size()));
+            for (int attempt = 0; attempt < 8; ++attempt) {
+                int64_t candidate = lo + static_cast<int64_t>(rng.below(static_cast<uint64_t>(hi - lo) + 1));
+                if (!binary_search(sorted.begin(), sorted.end(), static_cast<int>(candidate))) {
+                    miss = candidate;
+                    break;
+                }
+            }
+            if (miss > numeric_limits<int>::max()) miss = lo - 1 - static_cast<int64_t>(rng.below(sorted.size()));
+            targets[i] = static_cast<int>(max<int64_t>(miss, numeric_limits<int>::min()));
+        }
+        return targets;
+    }
+    
+    // Times search(targets, count, out) over the whole batch for throughput, then groups of
+    // `group` queries one at a time for the latency percentiles
+    template <class Search>
+    QueryThroughput measureQueries(const string& name, size_t group, const vector<int>& targets,
+                                   const QueryBatchConfig& config, Search search) {
+        QueryThroughput result;
+        result.engine = name;
+        if (targets.empty()) return result;
+        
+        vector<int> answers(targets.size());
+        BenchmarkConfig batchConfig;
+        batchConfig.warmupRuns = 1;
+        batchConfig.minRuns = 3;
+        batchConfig.maxRuns = 10;
+        batchConfig.timeBudget = 0.5;
+        BenchmarkEngine engine(batchConfig);
+        BenchmarkStats stats = engine.run([&]() {
+            chrono::steady_clock::time_point start = chrono::steady_clock::now();
+            search(targets.data(), targets.size(), answers.data());
+            return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        });
+        result.queriesPerSecond = stats.median > 0.0 ? targets.size() / stats.median : 0.0;
+        
+        size_t hits = 0;
+        for (size_t i = 0; i < targets.size(); ++i) hits += answers[i] == targets[i];
+        result.hitRatio = static_cast<double>(hits) / targets.size();
+        
+        // Subtract the cost of reading the clock twice from every latency sample
+        vector<double> overhead(1000);
+        for (double& o : overhead) {
+            chrono::steady_clock::time_point start = chrono::steady_clock::now();
+            o = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        }
+        sort(overhead.begin(), overhead.end());
+        double clockCost = BenchmarkEngine::percentile(overhead, 0.5);
+        
+        vector<double> latencies;
+        size_t sampled = min(targets.size(), config.latencySamples);
+        for (size_t i = 0; i < sampled; i += group) {
+            size_t count = min(group, sampled - i);
+            chrono::steady_clock::time_point start = chrono::steady_clock::now();
+            search(targets.data() + i, count, answers.data() + i);
+            double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            latencies.insert(latencies.end(), count, max(0.0, seconds - clockCost));
+        }
+        sort(latencies.begin(), latencies.end());
+        result.p50 = BenchmarkEngine::percentile(latencies, 0.50);
+        result.p90 = BenchmarkEngine::percentile(latencies, 0.90);
+        result.p99 = BenchmarkEngine::percentile(latencies, 0.99);
+        result.p999 = BenchmarkEngine::percentile(latencies, 0.999);
+        return result;
+    }
+    
+    template <class T>
+    vector<T> convertedArray() const {
+        vector<T> converted;
+        converted.reserve(arena.size());
+        for (int value : arena) {
+            converted.push_back(T(value));
+        }
+        return converted;
+    }
+    
+    // Benchmarks one sort on the loaded keys stored as element type T
+    template <class T, class Compare>
+    double benchmarkElementType(size_t index, Compare comp, OperationCounts& counts) {
+        const vector<T> source = convertedArray<T>();
+        vector<T> work;
+        
+        BenchmarkStats stats = benchmark.run([&]() {
+            work = source;
+            NullOps ops;
+            chrono::steady_clock::time_point start = chrono::steady_clock::now();
+            sortRange(index, work.begin(), work.end(), comp, ops);
+            return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        });
+        
+        work = source;
+        CountingOps counter;
+        sortRange(index, work.begin(), work.end(), comp, counter);
+        counts = counter.counts;
+        return stats.median;
+    }
+    
+public:
+    // Speedup and efficiency of the parallel sorts from 1 thread up to maxThreads
+    void threadScaling(size_t maxThreads) {
+        const vector<size_t> parallelIndices = {7, 8, 21, 22};
+        size_t savedThreads = threadCount;
+        
+        vector<size_t> counts;
+        for (size_t t = 1; t < maxThreads; t *= 2) counts.push_back(t);
+        counts.push_back(maxThreads);
+        
+        cout << "\n=== THREAD SCALING (" << arena.size() << " elements, cutoff " << parallelCutoff << ") ===" << endl;
+        cout << setw(8) << right << "Threads";
+        for (size_t index : parallelIndices) {
+            cout << "  " << setw(20) << left << algorithmNames[index] << setw(9) << right << "Speedup"
+                 << setw(11) << right << "Efficiency";
+        }
+        cout << endl;
+        
+        vector<double> baseline(parallelIndices.size(), 0.0);
+        for (size_t t : counts) {
+            setThreadCount(t);
+            cout << setw(8) << right << t;
+            
+            for (size_t k = 0; k < parallelIndices.size(); ++k) {
+                double median = benchmarkAlgorithm(parallelIndices[k]).median;
+                if (t == 1) baseline[k] = median;
+                double speedup = median > 0.0 ? baseline[k] / median : 0.0;
+                
+                cout << "  " << setw(20) << left << formatDuration(median)
+                     << setw(8) << right << fixed << setprecision(2) << speedup << "x"
+                     << setw(10) << right << fixed << setprecision(1) << speedup / t * 100.0 << "%";
+            }
+            cout << endl;
+        }
+        
+        setThreadCount(savedThreads);
+    }
+    
+    // Shows how element size changes the cost of each sort on the loaded array
+    void compareElementTypes() {
+        cout << "\n=== ELEMENT TYPE COMPARISON (median time per run) ===" << endl;
+        cout << "Keys: loaded array (" << arena.size() << " elements); records sort by a 64-bit key field" << endl;
+        
+        const vector<string> typeNames = {"int32", "int64", "double", "record16", "record64", "record256"};
+        const vector<size_t> typeSizes = {sizeof(int32_t), sizeof(int64_t), sizeof(double),
+                                          sizeof(Record<16>), sizeof(Record<64>), sizeof(Record<256>)};
+        
+        vector<vector<double>> times(algorithmNames.size());
+        vector<vector<uint64_t>> bytesMoved(algorithmNames.size());
+        
+        for (size_t index = 2; index < algorithmNames.size(); ++index) {
+            vector<OperationCounts> counts(typeNames.size());
+            times[index].push_back(benchmarkElementType<int32_t>(index, less<int32_t>(), counts[0]));
+            times[index].push_back(benchmarkElementType<int64_t>(index, less<int64_t>(), counts[1]));
+            times[index].push_back(benchmarkElementType<double>(index, less<double>(), counts[2]));
+            times[index].push_back(benchmarkElementType<Record<16> >(index, KeyLess(), counts[3]));
+            times[index].push_back(benchmarkElementType<Record<64> >(index, KeyLess(), counts[4]));
+            times[index].push_back(benchmarkElementType<Record<256> >(index, KeyLess(), counts[5]));
+            
+            // A swap moves three elements; every other write moves one
+            for (size_t t = 0; t < typeNames.size(); ++t) {
+                bytesMoved[index].push_back((3 * counts[t].swaps + counts[t].writes) * typeSizes[t]);
+            }
+        }
+        
+        cout << setw(22) << left << "Algorithm";
+        for (const string& name : typeNames) cout << setw(14) << right << name;
+        cout << endl;
+        for (size_t index = 2; index < algorithmNames.size(); ++index) {
+            cout << setw(22) << left << algorithmNames[index];
+            for (double t : times[index]) cout << setw(14) << right << formatDuration(t);
+            cout << endl;
+        }
+        
+        cout << "\n=== DATA MOVED PER RUN (bytes) ===" << endl;
+        cout << setw(22) << left << "Algorithm";
+        for (const string& name : typeNames) cout << setw(14) << right << name;
+        cout << endl;
+        for (size_t index = 2; index < algorithmNames.size(); ++index) {
+            cout << setw(22) << left << algorithmNames[index];
+            for (uint64_t bytes : bytesMoved[index]) cout << setw(14) << right << bytes;
+            cout << endl;
+        }
+    }
+    
+    // Cache levels from the memory profile of this session, the C library's figures before one ran
+    MemoryLevels memoryLevels() const {
+        if (memoryProfile.levels.empty()) return MemoryLevels::reported(CacheSizes::detect());
+        return MemoryLevels::fromProfile(memoryProfile);
+    }
+    
+    // Huge pages back the benchmark buffers and add a huge page latency curve to the profile
+    void setHugePages(bool enabled) {
+        hugePages = enabled;
+        arena.setHugePages(enabled);
+    }
+    
+    bool hugePagesEnabled() const { return hugePages; }
+    
+    // Measures latency and bandwidth up to maxBytes; later tables mark the levels found
+    const MemoryProfile& profileMemory(size_t maxBytes) {
+        memoryProfile = MemoryProbe::measure(maxBytes, hugePages);
+        return memoryProfile;
+    }
+    
+    void displayMemoryProfile(const MemoryProfile& profile) const {
+        bool huge = !profile.hugeLatency.empty();
+        cout << "\n=== MEMORY HIERARCHY (random pointer chase, streaming read) ===" << endl;
+        cout << setw(12) << right << "Working set" << setw(14) << right << "Latency";
+        if (huge) cout << setw(14) << right << "Huge pages";
+        cout << setw(14) << right << "Bandwidth" << endl;
+        
+        MemoryLevels measured = MemoryLevels::fromProfile(profile);
+        for (size_t k = 0; k < profile.bytes.size(); ++k) {
+            ostringstream latency, hugeLatency, bandwidth;
+            latency << fixed << setprecision(1) << profile.latency[k] << " ns";
+            bandwidth << fixed << setprecision(1) << profile.bandwidth[k] / 1e9 << " GB/s";
+            cout << setw(12) << right << formatBytes(static_cast<double>(profile.bytes[k])) << setw(14) << right << latency.str();
+            if (huge) {
+                hugeLatency << fixed << setprecision(1) << profile.hugeLatency[k] << " ns";
+                cout << setw(14) << right << hugeLatency.str();
+            }
+            cout << setw(14) << right << bandwidth.str();
+            string level = measured.crossed(k > 0 ? profile.bytes[k - 1] : 0, profile.bytes[k]);
+            if (!level.empty()) cout << "  > " << level;
+            cout << endl;
+        }
+        
+        cout << "Cache levels: " << (profile.levels.empty() ? string("no latency steps found") : measured.describe()) << endl;
+        cout << "Reported by the C library: " << MemoryLevels::reported(CacheSizes::detect()).describe() << endl;
+        if (huge && !profile.hugeBacked) {
+            cout << "The kernel refused huge pages (see /sys/kernel/mm/transparent_hugepage/enabled); "
+                 << "both latency columns use base pages." << endl;
+        } else if (huge) {
+            cout << "Latency above the huge page column is spent on TLB misses and page walks; "
+                 << "levels come from the huge page curve." << endl;
+        } else {
+            cout << "Steps can include TLB reach as well as cache capacity; turn on huge pages to separate them." << endl;
+        }
+    }
+    
+    // Per-query latency of every search structure on uniform keys from 1 KB up to maxBytes.
+    // Keys span twice the element count, so about half of the queries hit.
+    SearchLatencyResult searchLatency(size_t maxBytes) {
+        const size_t queryCount = 1 << 16;
+        BenchmarkConfig config;
+        config.warmupRuns = 1;
+        config.minRuns = 3;
+        config.maxRuns = 20;
+        config.timeBudget = 0.1;
+        config.targetRelativeError = 0.02;
+        
+        SearchLatencyResult result;
+        result.engines = {"Binary Search", "Branchless Binary", "Eytzinger", "S-tree", "Linear Search",
+                          string("Linear (") + searchKernels->name + ")"};
+        result.latencies.resize(result.engines.size());
+        
+        for (size_t bytes = 1024; bytes <= maxBytes; bytes *= 2) {
+            size_t n = bytes / sizeof(int);
+            result.bytes.push_back(bytes);
+            cout << "Measuring " << formatBytes(bytes) << "..." << flush;
+            
+            GeneratorParams params;
+            params.minVal = 0;
+            params.maxVal = static_cast<int>(min<size_t>(2 * n, numeric_limits<int>::max() - 1));
+            vector<int> keys = generateArray(Distribution::Uniform, n, params);
+            
+            SplitMix64 rng(seeded ? seed : 0x5EED);
+            vector<int> queries(queryCount);
+            for (int& q : queries) q = static_cast<int>(rng.below(params.maxVal + 1));
+            // Linear scans touch n elements per query; fewer queries keep them within budget
+            vector<int> scanQueries(queries.begin(), queries.begin() + max<size_t>(16, min(queryCount, (1 << 24) / n)));
+            
+            if (bytes <= result.linearLimit) {
+                result.latencies[4].push_back(queryLatency([&keys](int key) {
+                    NullOps ops;
+                    return static_cast<int>(algorithms::linearSearch(keys.begin(), keys.end(), key, less<int>(), ops) - keys.begin());
+                }, scanQueries, config));
+                const simd::SearchKernels& kernels = *searchKernels;
+                result.latencies[5].push_back(queryLatency([&keys, &kernels](int key) {
+                    NullOps ops;
+                    return static_cast<int>(algorithms::vectorLinearSearch(keys.begin(), keys.end(), key, less<int>(),
+                                                                           ops, kernels) - keys.begin());
+                }, scanQueries, config));
+            } else {
+                result.latencies[4].push_back(-1.0);
+                result.latencies[5].push_back(-1.0);
+            }
+            
+            sort(keys.begin(), keys.end());
+            result.latencies[0].push_back(queryLatency([&keys](int key) {
+                NullOps ops;
+                return static_cast<int>(algorithms::binarySearch(keys.begin(), keys.end(), key, less<int>(), ops) - keys.begin());
+            }, queries, config));
+            
+            // Each structure is built, measured and released before the next one
+            {
+                lookup::BranchlessBinary engine(keys);
+                result.latencies[1].push_back(queryLatency([&engine](int key) { return engine.lowerBound(key); }, queries, config));
+            }
+            {
+                lookup::Eytzinger engine(keys);
+                result.latencies[2].push_back(queryLatency([&engine](int key) { return engine.lowerBound(key); }, queries, config));
+            }
+            {
+                lookup::STree engine(keys, *searchKernels);
+                result.latencies[3].push_back(queryLatency([&engine](int key) { return engine.lowerBound(key); }, queries, config));
+            }
+            cout << " done" << endl;
+        }
+        return result;
+    }
+    
+    void displaySearchLatency(const SearchLatencyResult& result) const {
+        MemoryLevels levels = memoryLevels();
+        cout << "\n=== SEARCH LATENCY (time per dependent query) ===" << endl;
+        cout << "Caches: " << levels.describe() << "; S-tree nodes use " << searchKernels->name << " kernels" << endl;
+        
+        cout << setw(10) << right << "Array";
+        for (const string& name : result.engines) cout << setw(20) << right << name;
+        cout << endl;
+        
+        for (size_t k = 0; k < result.bytes.size(); ++k) {
+            cout << setw(10) << right << formatBytes(result.bytes[k]);
+            for (size_t e = 0; e < result.engines.size(); ++e) {
+                double t = result.latencies[e][k];
+                cout << setw(20) << right << (t < 0.0 ? string("skipped") : formatDuration(t));
+            }
+            // Marks the first size that no longer fits a cache level
+            string level = levels.crossed(k > 0 ? result.bytes[k - 1] : 0, result.bytes[k]);
+            if (!level.empty()) cout << "  > " << level;
+            cout << endl;
+        }
+        cout << "Linear scans are skipped above " << formatBytes(result.linearLimit) << "." << endl;
+    }
+    
+    // Throughput and latency percentiles of every search engine on a batch of targets drawn
+    // from the loaded array
+    vector<QueryThroughput> queryThroughput(const QueryBatchConfig& config) {
+        const vector<int>& sorted = arena.sortedView();
+        vector<int> targets = makeQueryTargets(sorted, config);
+        
+        vector<QueryThroughput> results;
+        results.push_back(measureQueries("Binary Search", 1, targets, config, [&sorted](const int* t, size_t count, int* out) {
+            NullOps ops;
+            for (size_t i = 0; i < count; ++i) {
+                vector<int>::const_iterator found = algorithms::binarySearch(sorted.begin(), sorted.end(), t[i], less<int>(), ops);
+                out[i] = found == sorted.end() ? lookup::kNoKey : *found;
+            }
+        }));
+        {
+            lookup::BranchlessBinary engine(sorted);
+            results.push_back(measureQueries("Branchless Binary", 1, targets, config, [&engine](const int* t, size_t count, int* out) {
+                for (size_t i = 0; i < count; ++i) out[i] = engine.lowerBound(t[i]);
+            }));
+            results.push_back(measureQueries("Branchless (interleaved)", lookup::kInterleave, targets, config,
+                                             [&engine](const int* t, size_t count, int* out) {
+                engine.lowerBoundBatch(t, count, out);
+            }));
+        }
+        {
+            lookup::Eytzinger engine(sorted);
+            results.push_back(measureQueries("Eytzinger", 1, targets, config, [&engine](const int* t, size_t count, int* out) {
+                for (size_t i = 0; i < count; ++i) out[i] = engine.lowerBound(t[i]);
+            }));
+            results.push_back(measureQueries("Eytzinger (interleaved)", lookup::kInterleave, targets, config,
+                                             [&engine](const int* t, size_t count, int* out) {
+                engine.lowerBoundBatch(t, count, out);
+            }));
+        }
+        {
+            lookup::STree engine(sorted, *searchKernels);
+            results.push_back(measureQueries("S-tree", 1, targets, config, [&engine](const int* t, size_t count, int* out) {
+                for (size_t i = 0; i < count; ++i) out[i] = engine.lowerBound(t[i]);
+            }));
+        }
+        return results;
+    }
+    
+    void displayQueryThroughput(const QueryBatchConfig& config, const vector<QueryThroughput>& results) const {
+        cout << "\n=== BATCH QUERY THROUGHPUT (" << config.queries << " queries on " << arena.size()
+             << " elements, " << InputGenerator::info(config.distribution).name << " hits) ===" << endl;
+        cout << setw(26) << left << "Engine" << setw(14) << right << "Queries/s"
+             << setw(12) << right << "p50" << setw(12) << right << "p90"
+             << setw(12) << right << "p99" << setw(12) << right << "p99.9" << setw(8) << right << "Hits" << endl;
+        
+        for (const QueryThroughput& r : results) {
+            ostringstream rate, hits;
+            rate << scientific << setprecision(3) << r.queriesPerSecond;
+            hits << fixed << setprecision(1) << r.hitRatio * 100.0 << "%";
+            cout << setw(26) << left << r.engine << setw(14) << right << rate.str()
+                 << setw(12) << right << formatDuration(r.p50) << setw(12) << right << formatDuration(r.p90)
+                 << setw(12) << right << formatDuration(r.p99) << setw(12) << right << formatDuration(r.p999)
+                 << setw(8) << right << hits.str() << endl;
+        }
+        cout << "Latency runs from issuing a query to its answer; interleaved engines answer a group of "
+             << lookup::kInterleave << " together." << endl;
+    }
+    
+    // Sorts a file of raw int32 keys that need not fit in memory; runs are sorted with the
+    // algorithm at sortIndex. Returns false and prints the reason on failure.
+    bool externalSort(const ExternalSortConfig& config, size_t sortIndex, ExternalSortResult& result) {
+        ExternalSorter sorter(config, [this, sortIndex](vector<int>& keys, size_t n) {
+            NullOps ops;
+            sortRange(sortIndex, keys.begin(), keys.begin() + n, less<int>(), ops);
+        });
+        if (!sorter.run(result)) {
+            cout << sorter.lastError() << endl;
+            return false;
+        }
+        return true;
+    }
+    
+    void displayExternalSort(const ExternalSortConfig& config, size_t sortIndex, const ExternalSortResult& result) const {
+        uint64_t inputBytes = result.keys * sizeof(int);
+        cout << "\n=== EXTERNAL SORT ===" << endl;
+        cout << "Input: " << config.input << " (" << result.keys << " keys, " << formatBytes(inputBytes) << ")" << endl;
+        cout << "Output: " << config.output << endl;
+        cout << "Runs: " << result.runs << " of up to " << result.runKeys << " keys, sorted with "
+             << algorithmNames[sortIndex] << "; memory budget " << formatBytes(config.memoryBytes) << endl;
+        cout << "Run formation: " << formatDuration(result.runSeconds)
+             << ", merge: " << formatDuration(result.mergeSeconds)
+             << ", total: " << formatDuration(result.totalSeconds) << endl;
+        if (result.totalSeconds > 0.0) {
+            cout << "Throughput: " << fixed << setprecision(3) << inputBytes / result.totalSeconds / 1e9
+                 << " GB/s of input, " << (result.bytesRead + result.bytesWritten) / result.totalSeconds / 1e9
+                 << " GB/s of I/O" << endl;
+        }
+        cout << "I/O volume: " << formatBytes(result.bytesRead) << " read, " << formatBytes(result.bytesWritten)
+             << " written (" << fixed << setprecision(1)
+             << (inputBytes ? static_cast<double>(result.bytesRead + result.bytesWritten) / inputBytes : 0.0)
+             << "x the input)" << endl;
+    }
+    
+    // Runs one algorithm on the loaded array; returns the seconds spent in its timed region
+    double runAlgorithm(size_t index, bool verbose = false) {
+        switch (index) {
+            // The middle element gives linear search its expected cost instead of a first-step hit
+            case 0: linearSearch(arena[arena.size() / 2], verbose); break;
+            case 1: binarySearch(arena[arena.size() / 2], verbose); break;
+            case 2: bubbleSort(verbose); break;
+            case 3: mergeSort(verbose); break;
+            case 4: quickSort(verbose); break;
+            case 5: selectionSort(verbose); break;
+            case 6: insertionSort(verbose); break;
+            default: execute(index, 0, verbose); break;
+        }
+        return algorithmTimes[index];
+    }
+    
+    // Repeats an algorithm under the benchmark engine and stores its statistics
+    const BenchmarkStats& benchmarkAlgorithm(size_t index) {
+        vector<vector<double>> counterRuns;
+        algorithmStats[index] = benchmark.run([this, index, &counterRuns]() {
+            double seconds = runAlgorithm(index);
+            if (countersEnabled) counterRuns.push_back(perfCounters.lastValues());
+            return seconds;
+        });
+        algorithmTimes[index] = algorithmStats[index].median;
+        
+        if (countersEnabled) {
+            // Warm-up runs come first; only measured runs contribute to the medians
+            counterRuns.erase(counterRuns.begin(), counterRuns.begin() + algorithmStats[index].warmupRuns);
+            algorithmStats[index].counters = counterMedians(counterRuns);
+        }
+        return algorithmStats[index];
+    }
+    
+    // Runs an algorithm once more with operation counting and records the peak memory of that
+    // run; timings are left untouched
+    const OperationCounts& countAlgorithm(size_t index) {
+        double savedTime = algorithmTimes[index];
+        bool savedCounting = countOperations;
+        countOperations = true;
+        bool peakReset = PeakMemory::reset();
+        runAlgorithm(index);
+        algorithmPeakMemory[index] = peakReset ? PeakMemory::peakBytes() : 0;
+        countOperations = savedCounting;
+        algorithmTimes[index] = savedTime;
+        return algorithmOperations[index];
+    }
+    
+    // Takes over the results of a job the scheduler ran on a copy of the loaded keys. Peak
+    // memory is per process, so it is unknown for jobs that ran side by side.
+    void importJob(const BenchmarkJob& job) {
+        size_t index = job.algorithm;
+        algorithmStats[index] = job.stats;
+        algorithmOperations[index] = job.operations;
+        algorithmTimes[index] = job.stats.median;
+        algorithmPeakMemory[index] = 0;
+        algorithmSkipped[index] = job.skipped;
+    }
+    
+    // Performance comparison feature. Without measured jobs every algorithm is benchmarked
+    // here, one after another; algorithms predicted to overrun the job timeout are skipped.
+    void compareAlgorithms(const vector<BenchmarkJob>* measured = nullptr) {
+        cout << "\n=== ALGORITHM PERFORMANCE COMPARISON ===" << endl;
+        displayArray(arena.begin(), arena.end(), "Test Array");
+        cout << "Distribution: " << distributionName << " (" << arena.size() << " elements)"
+             << ", SIMD kernels: " << sortKernels->name << endl;
+        displayArenaFootprint();
+        displayHybridThresholds();
+        cout << endl;
+        
+        if (measured) {
+            for (const BenchmarkJob& job : *measured) importJob(job);
+        } else {
+            // Benchmark each algorithm, then count its operations in a separate run
+            for (size_t i = 0; i < algorithmNames.size(); ++i) {
+                double predicted = 0.0;
+                algorithmSkipped[i] = predictedOverrun(i, &predicted);
+                if (algorithmSkipped[i]) {
+                    cout << "Skipping " << algorithmNames[i] << ": predicted " << formatDuration(predicted)
+                         << ", over the " << formatDuration(jobTimeout) << " job timeout" << endl;
+                    algorithmStats[i] = BenchmarkStats();
+                    algorithmOperations[i] = OperationCounts();
+                    algorithmTimes[i] = numeric_limits<double>::infinity();
+                    algorithmPeakMemory[i] = 0;
+                    continue;
+                }
+                benchmarkAlgorithm(i);
+                countAlgorithm(i);
+            }
+        }
+        for (size_t i = 0; i < algorithmNames.size(); ++i) {
+            if (algorithmSkipped[i]) algorithmTimes[i] = numeric_limits<double>::infinity();
+        }
+        
+        // Display results
+        cout << "┌────────────────────────┬──────────────┬──────────────┬──────────────┬──────────────┬────────┬──────────┐" << endl;
+        cout << "│     Algorithm          │     Min      │    Median    │     P95      │    StdDev    │  Runs  │  Allocs  │" << endl;
+        cout << "├────────────────────────┼──────────────┼──────────────┼──────────────┼──────────────┼────────┼──────────┤" << endl;
+        
+        auto minIt = min_element(algorithmTimes.begin(), algorithmTimes.end());
+        size_t fastestIndex = distance(algorithmTimes.begin(), minIt);
+        
+        for (size_t i = 0; i < algorithmNames.size(); ++i) {
+            const BenchmarkStats& stats = algorithmStats[i];
+            if (algorithmSkipped[i]) {
+                cout << "│ " << setw(22) << left << algorithmNames[i] << " │ " << setw(12) << right << "skipped"
+                     << " │              │              │              │        │          │" << endl;
+                continue;
+            }
+            cout << "│ " << setw(22) << left << algorithmNames[i] << " │ "
+                 << setw(12) << right << formatDuration(stats.minTime) << " │ "
+                 << setw(12) << right << formatDuration(stats.median) << " │ "
+                 << setw(12) << right << formatDuration(stats.p95) << " │ "
+                 << setw(12) << right << formatDuration(stats.stddev) << " │ "
+                 << setw(6) << right << stats.samples.size() << " │ "
+                 << setw(8) << right << algorithmOperations[i].allocations;
+            if (i == fastestIndex) {
+                cout << " │ ⭐" << endl;
+            } else {
+                cout << " │" << endl;
+            }
+        }
+        cout << "└────────────────────────┴──────────────┴──────────────┴──────────────┴──────────────┴────────┴──────────┘" << endl;
+        
+        cout << "\n🏆 Fastest Algorithm: " << algorithmNames[fastestIndex] 
+             << " (median " << formatDuration(*minIt) << ")" << endl;
+        
+        displayOperationTable();
+        displayPresortedness(measurePresortedness(arena.begin(), arena.end()));
+        
+        if (countersEnabled) {
+            displayCounters();
+        }
+    }
+    
+    // Presortedness of the input, and what it means for the adaptive sorts in the last comparison
+    void displayPresortedness(const Presortedness& p) const {
+        const size_t merge = 3, insertion = 6, introsort = 11, powersort = 19;
+        double n = static_cast<double>(p.size);
+        double pairs = n * (n - 1) / 2;
+        
+        cout << "\n=== PRESORTEDNESS ===" << endl;
+        cout << "Ascending runs:     " << p.runs << " (longest " << p.longestRun << ")" << endl;
+        cout << "Monotone runs:      " << p.monotoneRuns << " (descending runs reversed)" << endl;
+        cout << "Inversions:         " << p.inversions << fixed << setprecision(2)
+             << " (" << (pairs > 0 ? 100.0 * p.inversions / pairs : 0.0) << "% of all pairs)" << endl;
+        cout << "Longest increasing: " << p.increasing << " (" << p.size - p.increasing << " keys out of place)" << endl;
+        if (p.size < 2) return;
+        
+        cout << "\nWhy adaptive sorts win (or don't) here:" << endl;
+        double mergeBound = n * log2(n);
+        double runBound = n * log2(max<double>(p.monotoneRuns, 1.0)) + n;
+        cout << "- Powersort merges the " << p.monotoneRuns << " natural runs instead of splitting blindly: its merges need about n·log2(runs) + n = "
+             << setprecision(0) << runBound << " comparisons against n·log2(n) = " << mergeBound
+             << " for merge sort; it used " << algorithmOperations[powersort].comparisons << " in all, merge sort "
+             << algorithmOperations[merge].comparisons << "." << endl;
+        cout << "- Galloping copies stretches of one run in O(log k) comparisons each, so runs that barely "
+             << "interleave merge in far fewer than n comparisons." << endl;
+        cout << "- Insertion sort does n + inversions = " << setprecision(0) << n + p.inversions << " steps (";
+        if (algorithmSkipped[insertion]) cout << "skipped here"; else cout << "it made " << algorithmOperations[insertion].writes << " writes";
+        cout << "): linear when few pairs are inverted, quadratic (n²/4 = " << n * n / 4 << ") on random input." << endl;
+        
+        const BenchmarkStats& power = algorithmStats[powersort];
+        if (power.median > 0.0 && algorithmStats[merge].median > 0.0 && algorithmStats[introsort].median > 0.0) {
+            cout << "- Measured: Powersort " << formatDuration(power.median) << " vs merge sort "
+                 << formatDuration(algorithmStats[merge].median) << " and introsort "
+                 << formatDuration(algorithmStats[introsort].median) << setprecision(2) << " ("
+                 << algorithmStats[merge].median / power.median << "x and "
+                 << algorithmStats[introsort].median / power.median << "x)." << endl;
+        }
+        if (p.monotoneRuns > p.size / 8) {
+            cout << "- With runs this short the input is close to random: adaptivity has little to exploit "
+                 << "and run detection is pure overhead." << endl;
+        }
+    }
+    
+    void displayHybridThresholds() const {
+        cout << "Hybrid sort: network up to " << hybridLimits.networkLimit << ", insertion up to "
+             << hybridLimits.insertionLimit << ", radix from ";
+        if (hybridLimits.radixLimit == numeric_limits<size_t>::max()) cout << "never"; else cout << hybridLimits.radixLimit;
+        cout << " elements (" << (hybridCalibrated ? "calibrated" : "defaults, not calibrated") << ")" << endl;
+    }
+    
+    // Times the hybrid sort candidates on this machine and switches to the thresholds found
+    HybridCalibration calibrateHybrid() {
+        HybridCalibration result = HybridTuner::calibrate();
+        hybridLimits = result.thresholds;
+        hybridCalibrated = true;
+        return result;
+    }
+    
+    void displayHybridCalibration(const HybridCalibration& result) const {
+        cout << "\n=== HYBRID SORT CALIBRATION (ns per sort, random keys) ===" << endl;
+        cout << setw(8) << right << "n" << setw(12) << right << "Network" << setw(12) << right << "Insertion" << endl;
+        for (size_t i = 0; i < result.smallSizes.size(); ++i) {
+            cout << setw(8) << right << result.smallSizes[i] << fixed << setprecision(1)
+                 << setw(12) << right << result.networkTimes[i] << setw(12) << right << result.insertionTimes[i] << endl;
+        }
+        cout << endl << setw(8) << right << "n" << setw(12) << right << "Insertion" << setw(12) << right << "Introsort" << endl;
+        for (size_t i = 0; i < result.mediumSizes.size(); ++i) {
+            cout << setw(8) << right << result.mediumSizes[i] << setw(12) << right << result.insertionMediumTimes[i]
+                 << setw(12) << right << result.introTimes[i] << endl;
+        }
+        cout << endl << setw(8) << right << "n" << setw(12) << right << "Introsort" << setw(12) << right << "Radix (8)" << endl;
+        for (size_t i = 0; i < result.largeSizes.size(); ++i) {
+            cout << setw(8) << right << result.largeSizes[i] << setw(12) << right << result.introLargeTimes[i]
+                 << setw(12) << right << result.radixTimes[i] << endl;
+        }
+        cout << endl;
+        displayHybridThresholds();
+    }
+    
+    bool saveHybridThresholds(const string& path) const {
+        return HybridTuner::save(path, hybridLimits);
+    }
+    
+    // Memory held by the input and its derived buffers; the working copy and the sorted view
+    // only exist once a sort or a binary search has needed them
+    void displayArenaFootprint() const {
+        cout << "Memory: input " << formatBytes(arena.inputBytes()) << (arena.isMapped() ? " (mapped)" : "")
+             << ", sort buffer " << formatBytes(arena.workingBytes())
+             << ", sorted view " << formatBytes(arena.sortedBytes()) << "; the input fits in "
+             << memoryLevels().holding(arena.inputBytes()) << (hugePages ? ", huge pages" : "") << endl;
+    }
+    
+    // Operation counts of the last counted run next to each theoretical complexity
+    void displayOperationTable() const {
+        cout << "\n=== OPERATION COUNTS (one run) ===" << endl;
+        cout << setw(22) << left << "Algorithm" << "  " << setw(12) << left << "Complexity"
+             << setw(14) << right << "Comparisons" << setw(12) << right << "Swaps"
+             << setw(12) << right << "Writes" << setw(8) << right << "Allocs"
+             << setw(14) << right << "Alloc bytes" << setw(12) << right << "Peak RSS" << endl;
+        
+        for (size_t i = 0; i < algorithmNames.size(); ++i) {
+            const OperationCounts& ops = algorithmOperations[i];
+            cout << setw(22) << left << algorithmNames[i] << "  " << padRight(algorithmComplexities[i], 12);
+            if (algorithmSkipped[i]) {
+                cout << setw(14) << right << "skipped" << endl;
+                continue;
+            }
+            cout << setw(14) << right << ops.comparisons << setw(12) << right << ops.swaps
+                 << setw(12) << right << ops.writes << setw(8) << right << ops.allocations
+                 << setw(14) << right << ops.allocatedBytes
+                 << setw(12) << right << (algorithmPeakMemory[i] ? formatBytes(algorithmPeakMemory[i]) : string("n/a")) << endl;
+        }
+    }
+    
+    // Hardware counter columns for the last comparison, medians per run
+    void displayCounters() const {
+        cout << "\n=== HARDWARE COUNTERS (median per run) ===" << endl;
+        cout << setw(22) << left << "Algorithm";
+        for (size_t e = 0; e < perfCounters.eventCount(); ++e) {
+            cout << setw(14) << right << perfCounters.eventName(e);
+        }
+        cout << setw(8) << right << "IPC" << endl;
+        
+        for (size_t i = 0; i < algorithmNames.size(); ++i) {
+            const vector<double>& counters = algorithmStats[i].counters;
+            cout << setw(22) << left << algorithmNames[i];
+            for (size_t e = 0; e < perfCounters.eventCount(); ++e) {
+                if (e < counters.size() && !std::isnan(counters[e])) {
+                    cout << setw(14) << right << fixed << setprecision(0) << counters[e];
+                } else {
+                    cout << setw(14) << right << "n/a";
+                }
+            }
+            
+            // Instructions per cycle, when both counters are available
+            if (counters.size() > 1 && !std::isnan(counters[0]) && !std::isnan(counters[1]) && counters[0] > 0.0) {
+                cout << setw(8) << right << fixed << setprecision(2) << counters[1] / counters[0];
+            } else {
+                cout << setw(8) << right << "n/a";
+            }
+            cout << endl;
+        }
+        cout << "n/a: counter not supported or not permitted (see /proc/sys/kernel/perf_event_paranoid)" << endl;
+    }
+    
+    // Runs every algorithm over sizes 2^minExponent .. 2^maxExponent and fits growth models
+    SweepResult sweepAlgorithms(const SweepConfig& config = SweepConfig()) {
+        SweepResult result;
+        result.distribution = InputGenerator::info(config.distribution).name;
+        DataArena savedArena = std::move(arena);
+        string savedDistribution = distributionName;
+        uint64_t savedSeed = arraySeed;
+        BenchmarkConfig savedConfig = benchmark.getConfig();
+        benchmark.setConfig(config.benchmark);
+        
+        result.medians.resize(algorithmNames.size());
+        
+        for (int e = config.minExponent; e <= config.maxExponent; ++e) {
+            int size = 1 << e;
+            result.sizes.push_back(size);
+            
+            GeneratorParams params = config.params;
+            if (config.scaleRange) {
+                params.maxVal = max(params.maxVal, params.minVal + size - 1);
+            }
+            vector<int> generated = generateArray(config.distribution, size, params);
+            setArray(std::move(generated), result.distribution, generatorSeed);
+            
+            cout << "Measuring n = " << size << "..." << flush;
+            for (size_t i = 0; i < algorithmNames.size(); ++i) {
+                if (exceedsQuadraticLimit(i, size, config.quadraticLimit, result.distribution)) {
+                    result.medians[i].push_back(-1.0);
+                    continue;
+                }
+                result.medians[i].push_back(benchmarkAlgorithm(i).median);
+            }
+            cout << " done" << endl;
+        }
+        
+        for (size_t i = 0; i < algorithmNames.size(); ++i) {
+            vector<double> sizes, times;
+            for (size_t k = 0; k < result.sizes.size(); ++k) {
+                if (result.medians[i][k] < 0.0) continue;
+                sizes.push_back(result.sizes[k]);
+                times.push_back(result.medians[i][k]);
+            }
+            result.fits.push_back(fitComplexity(sizes, times));
+        }
+        
+        benchmark.setConfig(savedConfig);
+        arena = std::move(savedArena);
+        distributionName = savedDistribution;
+        arraySeed = savedSeed;
+        return result;
+    }
+    
+    void displaySweep(const SweepResult& result) const {
+        MemoryLevels levels = memoryLevels();
+        cout << "\n=== SIZE SWEEP (median time per run, " << result.distribution << " input) ===" << endl;
+        cout << "Caches: " << levels.describe() << "; rows marked > Lk are the first whose input no longer fits Lk" << endl;
+        cout << setw(10) << right << "n";
+        for (const string& name : algorithmNames) {
+            cout << setw(16) << right << name;
+        }
+        cout << endl;
+        
+        for (size_t k = 0; k < result.sizes.size(); ++k) {
+            cout << setw(10) << right << result.sizes[k];
+            for (size_t i = 0; i < algorithmNames.size(); ++i) {
+                double t = result.medians[i][k];
+                cout << setw(16) << right << (t < 0.0 ? string("skipped") : formatDuration(t));
+            }
+            size_t previous = k > 0 ? result.sizes[k - 1] * sizeof(int) : 0;
+            string level = levels.crossed(previous, result.sizes[k] * sizeof(int));
+            if (!level.empty()) cout << "  > " << level;
+            cout << endl;
+        }
+        
+        cout << "\n=== EMPIRICAL COMPLEXITY ===" << endl;
+        cout << "┌────────────────────────┬────────────┬────────────┬──────────────┬───────────┐" << endl;
+        cout << "│     Algorithm          │  Expected  │  Best fit  │   Constant   │ Fit error │" << endl;
+        cout << "├────────────────────────┼────────────┼────────────┼──────────────┼───────────┤" << endl;
+        for (size_t i = 0; i < algorithmNames.size(); ++i) {
+            const ComplexityFit& fit = result.fits[i];
+            ostringstream constant, error;
+            constant << scientific << setprecision(3) << fit.constant;
+            error << fixed << setprecision(1) << fit.error * 100.0 << "%";
+            cout << "│ " << setw(22) << left << algorithmNames[i]
+                 << " │ " << padRight(algorithmComplexities[i], 10)
+                 << " │ " << padRight(fit.model, 10)
+                 << " │ " << setw(12) << right << constant.str()
+                 << " │ " << setw(9) << right << error.str() << " │" << endl;
+        }
+        cout << "└────────────────────────┴────────────┴────────────┴──────────────┴───────────┘" << endl;
+        cout << "Constant is seconds per unit of the fitted model." << endl;
+        
+        displayCrossovers(result);
+    }
+    
+private:
+    static vector<double> counterMedians(const vector<vector<double>>& runs) {
+        vector<double> medians;
+        if (runs.empty()) return medians;
+        
+        for (size_t e = 0; e < runs[0].size(); ++e) {
+            vector<double> column;
+            for (const vector<double>& run : runs) {
+                if (!std::isnan(run[e])) column.push_back(run[e]);
+            }
+            if (column.empty()) {
+                medians.push_back(numeric_limits<double>::quiet_NaN());
+                continue;
+            }
+            sort(column.begin(), column.end());
+            medians.push_back(BenchmarkEngine::percentile(column, 0.50));
+        }
+        return medians;
+    }
+    
+    // Pads by display width so multi-byte symbols like ² keep the table aligned
+    static string padRight(const string& text, size_t width) {
+        size_t columns = 0;
+        for (unsigned char c : text) {
+            if ((c & 0xC0) != 0x80) ++columns;
+        }
+        return text + string(columns < width ? width - columns : 0, ' ');
+    }
+    
+    // Reports sizes where the faster of two comparable algorithms changes
+    void displayCrossovers(const SweepResult& result) const {
+        cout << "\n=== CROSSOVER POINTS ===" << endl;
+        bool any = false;
+        
+        for (size_t a = 0; a < algorithmNames.size(); ++a) {
+            for (size_t b = a + 1; b < algorithmNames.size(); ++b) {
+                // Only compare searches with searches and sorts with sorts
+                if ((a < 2) != (b < 2)) continue;
+                
+                int previous = 0;
+                for (size_t k = 0; k < result.sizes.size(); ++k) {
+                    double ta = result.medians[a][k], tb = result.medians[b][k];
+                    if (ta < 0.0 || tb < 0.0) continue;
+                    
+                    int faster = ta < tb ? -1 : (tb < ta ? 1 : 0);
+                    if (faster != 0 && previous != 0 && faster != previous) {
+                        const string& winner = faster < 0 ? algorithmNames[a] : algorithmNames[b];
+                        const string& loser = faster < 0 ? algorithmNames[b] : algorithmNames[a];
+                        cout << "  " << winner << " overtakes " << loser 
+                             << " between n = " << result.sizes[k - 1] << " and n = " << result.sizes[k] << endl;
+                        any = true;
+                    }
+                    if (faster != 0) previous = faster;
+                }
+            }
+        }
+        
+        if (!any) {
+            cout << "  No crossovers in the measured range." << endl;
+        }
+    }
+    
+public:
+    // Fixes the generator seed so every generated array can be reproduced
+    void setSeed(unsigned value) {
+        seed = value;
+        seeded = true;
+    }
+    
+    // Generates an input from the distribution library, in parallel on the worker pool
+    vector<int> generateArray(Distribution distribution, size_t size, const GeneratorParams& params) {
+        random_device rd;
+        generatorSeed = seeded ? seed : rd();
+        return InputGenerator::generate(distribution, size, generatorSeed, params, &workerPool());
+    }
+    
+    uint64_t getGeneratorSeed() const { return generatorSeed; }
+    
+    // Generate random array
+    vector<int> generateRandomArray(int size, int minVal = 1, int maxVal = 100) {
+        GeneratorParams params;
+        params.minVal = minVal;
+        params.maxVal = maxVal;
+        return generateArray(Distribution::Uniform, size, params);
+    }
+};
+
+const size_t AlgorithmVisualizer::kPilotKeys;
+
+// Runs benchmark jobs side by side. Every worker is pinned to its own physical core and
+// owns a visualizer, so each job sorts a private copy of its keys. Before the jobs start, a
+// probe sort runs on all workers at once; when it slows down by more than the noise
+// tolerance, shared caches, memory bandwidth or other tenants would skew the timings,
+// so the workers are halved, down to serial mode. Pilot runs predict every job: those
+// past the job timeout are skipped, the rest start longest first. Algorithms that use
+// the worker pool run last, alone and unpinned.
+class JobScheduler {
+private:
+    SchedulerConfig config;
+    ostream& log;
+    mutex logLock;
+    
+    // One logical CPU per physical core among those this process may run on
+    static vector<int> physicalCores() {
+        vector<int> cpus;
+#ifdef __linux__
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+            vector<pair<int, int>> cores;
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                if (!CPU_ISSET(cpu, &allowed)) continue;
+                string topology = "/sys/devices/system/cpu/cpu" + to_string(cpu) + "/topology/";
+                int package = -1, core = -1;
+                ifstream(topology + "physical_package_id") >> package;
+                ifstream(topology + "core_id") >> core;
+                pair<int, int> id(package, core);
+                // SMT siblings share a core with a CPU already taken
+                if (core >= 0 && find(cores.begin(), cores.end(), id) != cores.end()) continue;
+                cores.push_back(id);
+                cpus.push_back(cpu);
+            }
+        }
+#endif
+        if (cpus.empty()) {
+            for (unsigned cpu = 0; cpu < max(1u, thread::hardware_concurrency()); ++cpu) cpus.push_back(cpu);
+        }
+        return cpus;
+    }
+    
+    static bool pinToCpu(int cpu) {
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+        (void)cpu;
+        return false;
+#endif
+    }
+    
+    // Best of five introsorts of 1 MB of random keys: cache, memory and core bound alike
+    static double probeSeconds() {
+        vector<int> keys(1 << 18), work(keys.size());
+        SplitMix64 rng(0x5EED);
+        for (int& key : keys) key = static_cast<int>(rng.next());
+        
+        NullOps ops;
+        double best = numeric_limits<double>::infinity();
+        for (int round = 0; round < 5; ++round) {
+            copy(keys.begin(), keys.end(), work.begin());
+            chrono::steady_clock::time_point start = chrono::steady_clock::now();
+            algorithms::introSort(work.begin(), work.end(), less<int>(), ops);
+            best = min(best, chrono::duration<double>(chrono::steady_clock::now() - start).count());
+        }
+        return best;
+    }
+    
+    // Slowdown of the slowest CPU when all of them run the probe at once, against one alone
+    static double interference(const vector<int>& cpus) {
+        double solo = 0.0;
+        thread([&]() {
+            pinToCpu(cpus[0]);
+            solo = probeSeconds();
+        }).join();
+        
+        vector<double> times(cpus.size());
+        vector<thread> threads;
+        atomic<size_t> ready(0);
+        for (size_t i = 0; i < cpus.size(); ++i) {
+            threads.push_back(thread([&, i]() {
+                pinToCpu(cpus[i]);
+                ++ready;
+                while (ready.load() < cpus.size()) this_thread::yield();
+                times[i] = probeSeconds();
+            }));
+        }
+        for (thread& t : threads) t.join();
+        return *max_element(times.begin(), times.end()) / solo - 1.0;
+    }
+    
+    static bool sameInput(const BenchmarkJob& a, const BenchmarkJob& b) {
+        return a.keys == b.keys && a.distribution == b.distribution && a.size == b.size && a.seed == b.seed;
+    }
+    
+    // The first count keys of the job's input: copied from the shared keys or generated
+    static void loadInput(AlgorithmVisualizer& visualizer, const BenchmarkJob& job, size_t count) {
+        vector<int> keys;
+        if (job.keys) {
+            keys.assign(job.keys->begin(), job.keys->begin() + min(count, job.keys->size()));
+        } else {
+            keys = InputGenerator::generate(job.distribution, count, job.seed, job.params);
+        }
+        visualizer.setArray(std::move(keys), job.distributionName, job.seed);
+    }
+    
+    void report(const BenchmarkJob& job, const string& algorithm) {
+        lock_guard<mutex> guard(logLock);
+        log << (job.cpu >= 0 ? "[cpu " + to_string(job.cpu) + "] " : string("[pool] ")) << algorithm << ", "
+            << job.distributionName << ", n = " << job.size << ": median " << formatDuration(job.stats.median);
+        if (job.stats.timedOut) {
+            log << ", stopped after " << job.stats.samples.size() << (job.stats.samples.size() == 1 ? " run" : " runs")
+                << " by the job timeout";
+        }
+        log << endl;
+    }
+    
+public:
+    JobScheduler(const SchedulerConfig& cfg, ostream& out) : config(cfg), log(out) {}
+    
+    // Runs the jobs with the settings of the given visualizer; returns the workers used
+    size_t run(vector<BenchmarkJob>& jobs, const AlgorithmVisualizer& settings) {
+        const vector<string>& names = settings.getAlgorithmNames();
+        double timeout = settings.getJobTimeout();
+        {
+            AlgorithmVisualizer pilot;
+            settings.copySettingsTo(pilot);
+            const BenchmarkJob* loaded = nullptr;
+            for (BenchmarkJob& job : jobs) {
+                if (job.size <= AlgorithmVisualizer::kPilotKeys) continue;
+                if (!loaded || !sameInput(*loaded, job)) {
+                    loadInput(pilot, job, AlgorithmVisualizer::kPilotKeys);
+                    loaded = &job;
+                }
+                job.predicted = pilot.predictJob(job.algorithm, job.size);
+                job.skipped = timeout > 0.0 && job.predicted > timeout;
+                if (job.skipped) {
+                    log << "Skipping " << names[job.algorithm] << " at n = " << job.size << " on " << job.distributionName
+                        << " input: predicted " << formatDuration(job.predicted) << ", over the "
+                        << formatDuration(timeout) << " job timeout" << endl;
+                }
+            }
+        }
+        
+        vector<size_t> independent, pooled;
+        for (size_t i = 0; i < jobs.size(); ++i) {
+            if (jobs[i].skipped) continue;
+            (settings.usesWorkerPool(jobs[i].algorithm) ? pooled : independent).push_back(i);
+        }
+        stable_sort(independent.begin(), independent.end(),
+                    [&jobs](size_t a, size_t b) { return jobs[a].predicted > jobs[b].predicted; });
+        
+        vector<int> cpus = config.cpus.empty() ? physicalCores() : config.cpus;
+        size_t workers = config.workers == 0 ? cpus.size() : min(config.workers, cpus.size());
+        workers = max<size_t>(1, min(workers, independent.size()));
+        while (workers > 1) {
+            double slowdown = interference(vector<int>(cpus.begin(), cpus.begin() + workers));
+            if (slowdown <= config.noiseTolerance) break;
+            ostringstream percent;
+            percent << fixed << setprecision(0) << slowdown * 100.0;
+            log << "Probe sort is " << percent.str() << "% slower on " << workers << " cores at once than on one; ";
+            workers /= 2;
+            log << (workers > 1 ? "retrying with " + to_string(workers) + " workers" : string("running serially")) << endl;
+        }
+        
+        atomic<size_t> cursor(0);
+        vector<thread> threads;
+        for (size_t w = 0; w < workers; ++w) {
+            threads.push_back(thread([&, w]() {
+                int cpu = cpus[w];
+                bool pinned = pinToCpu(cpu);
+                AlgorithmVisualizer visualizer;
+                settings.copySettingsTo(visualizer);
+                visualizer.setThreadCount(1);
+                for (size_t next = cursor++; next < independent.size(); next = cursor++) {
+                    BenchmarkJob& job = jobs[independent[next]];
+                    job.cpu = pinned ? cpu : -1;
+                    loadInput(visualizer, job, job.size);
+                    job.stats = visualizer.benchmarkAlgorithm(job.algorithm);
+                    job.operations = visualizer.countAlgorithm(job.algorithm);
+                    report(job, names[job.algorithm]);
+                }
+            }));
+        }
+        for (thread& t : threads) t.join();
+        
+        if (!pooled.empty()) {
+            AlgorithmVisualizer visualizer;
+            settings.copySettingsTo(visualizer);
+            for (size_t index : pooled) {
+                BenchmarkJob& job = jobs[index];
+                loadInput(visualizer, job, job.size);
+                job.stats = visualizer.benchmarkAlgorithm(job.algorithm);
+                job.operations = visualizer.countAlgorithm(job.algorithm);
+                report(job, names[job.algorithm]);
+            }
+        }
+        return workers;
+    }
+};
+
+class MenuSystem {
+private:
+    AlgorithmVisualizer visualizer;
+    SchedulerConfig scheduler;
+    
+public:
+    void displayMainMenu() {
+        cout << "\n==========================================" << endl;
+        cout << "      ALGORITHM VISUALIZER & ANALYZER" << endl;
+        cout << "==========================================" << endl;
+        cout << "1. Linear Search" << endl;
+        cout << "2. Binary Search" << endl;
+        cout << "3. Bubble Sort" << endl;
+        cout << "4. Merge Sort" << endl;
+        cout << "5. Quick Sort" << endl;
+        cout << "6. Selection Sort" << endl;
+        cout << "7. Insertion Sort" << endl;
+        cout << "8. Compare All Algorithms" << endl;
+        cout << "9. Generate Random Array" << endl;
+        cout << "10. Size Sweep & Complexity Fit" << endl;
+        cout << "11. Toggle Hardware Counters (" << (visualizer.hardwareCountersEnabled() ? "on" : "off") << ")" << endl;
+        cout << "12. Compare Element Types" << endl;
+        cout << "13. Thread Scaling Report" << endl;
+        cout << "14. Search Latency Report" << endl;
+        cout << "15. Batch Query Throughput" << endl;
+        cout << "16. External Sort (file)" << endl;
+        cout << "17. Trace Replay" << endl;
+        cout << "18. Calibrate Hybrid Sort" << endl;
+        cout << "19. Memory Hierarchy Profile" << endl;
+        cout << "20. Concurrent Runner (" << (scheduler.workers == 1 ? string("serial") : scheduler.workers == 0
+                                                 ? string("all cores") : to_string(scheduler.workers) + " workers") << ")" << endl;
+        cout << "0. Exit" << endl;
+        cout << "==========================================" << endl;
+        cout << "Enter your choice (0-20): ";
+    }
+    
+    void run() {
+        int choice;
+        
+        do {
+            displayMainMenu();
+            cin >> choice;
+            
+            bool needsArray = (choice >= 1 && choice <= 8) || choice == 12 || choice == 13 || choice == 15;
+            if (needsArray && visualizer.getInput().empty()) {
+                cout << "No array data! Please generate or enter an array first (option 9)." << endl;
+                continue;
+            }
+            
+            switch (choice) {
+                case 1: {
+                    int target;
+                    cout << "Enter target value to search: ";
+                    cin >> target;
+                    visualizer.linearSearch(target);
+                    break;
+                }
+                case 2: {
+                    int target;
+                    cout << "Enter target value to search: ";
+                    cin >> target;
+                    visualizer.binarySearch(target);
+                    break;
+                }
+                case 3:
+                    visualizer.bubbleSort();
+                    break;
+                case 4:
+                    visualizer.mergeSort();
+                    break;
+                case 5:
+                    visualizer.quickSort();
+                    break;
+                case 6:
+                    visualizer.selectionSort();
+                    break;
+                case 7:
+                    visualizer.insertionSort();
+                    break;
+                case 8:
+                    handleCompare();
+                    break;
+                case 9:
+                    handleArrayInput();
+                    break;
+                case 10:
+                    handleSweep();
+                    break;
+                case 11:
+                    if (visualizer.hardwareCountersEnabled()) {
+                        visualizer.setHardwareCounters(false);
+                        cout << "Hardware counters disabled." << endl;
+                    } else if (visualizer.setHardwareCounters(true)) {
+                        cout << "Hardware counters enabled; they appear in the comparison report." << endl;
+                    } else {
+                        cout << "Hardware counters are not available on this system." << endl;
+                    }
+                    break;
+                case 12:
+                    visualizer.compareElementTypes();
+                    break;
+                case 13: {
+                    int maxThreads;
+                    cout << "Maximum thread count (this machine has " << thread::hardware_concurrency() << "): ";
+                    cin >> maxThreads;
+                    if (maxThreads < 1) {
+                        cout << "Invalid thread count!" << endl;
+                        break;
+                    }
+                    visualizer.threadScaling(maxThreads);
+                    break;
+                }
+                case 14:
+                    handleSearchLatency();
+                    break;
+                case 15:
+                    handleQueryBatch();
+                    break;
+                case 16:
+                    handleExternalSort();
+                    break;
+                case 17:
+                    handleTrace();
+                    break;
+                case 18: {
+                    cout << "Calibrating hybrid sort thresholds..." << endl;
+                    visualizer.displayHybridCalibration(visualizer.calibrateHybrid());
+                    string path = HybridTuner::defaultPath();
+                    if (visualizer.saveHybridThresholds(path)) {
+                        cout << "Saved to " << path << "; later runs start with these thresholds." << endl;
+                    } else {
+                        cout << "Cannot write " << path << "; the thresholds apply to this session only." << endl;
+                    }
+                    break;
+                }
+                case 19:
+                    handleMemoryProfile();
+                    break;
+                case 20:
+                    handleConcurrentRunner();
+                    break;
+                case 0:
+                    cout << "Thank you for using Algorithm Visualizer!" << endl;
+                    break;
+                default:
+                    cout << "Invalid choice! Please try again." << endl;
+            }
+            
+            if (choice != 0) {
+                cout << "\nPress Enter to continue...";
+                cin.ignore();
+                cin.get();
+            }
+            
+        } while (choice != 0);
+    }
+    
+private:
+    void handleSweep() {
+        SweepConfig config;
+        cout << "\n=== SIZE SWEEP ===" << endl;
+        cout << "Smallest size exponent (2^k, default " << config.minExponent << "): ";
+        cin >> config.minExponent;
+        cout << "Largest size exponent (2^k, default " << config.maxExponent << "): ";
+        cin >> config.maxExponent;
+        if (!readDistribution(config.distribution)) return;
+        
+        if (config.minExponent < 1 || config.maxExponent > 28 || config.minExponent > config.maxExponent) {
+            cout << "Invalid range! Exponents must satisfy 1 <= min <= max <= 28." << endl;
+            return;
+        }
+        
+        visualizer.displaySweep(visualizer.sweepAlgorithms(config));
+    }
+    
+    void handleSearchLatency() {
+        CacheSizes caches = CacheSizes::detect();
+        size_t defaultMb = max<size_t>(64, 2 * caches.llc >> 20);
+        cout << "\n=== SEARCH LATENCY ===" << endl;
+        cout << "Largest array in MB (0 = " << defaultMb << ", twice the LLC): ";
+        
+        long long mb;
+        cin >> mb;
+        if (mb <= 0) mb = defaultMb;
+        if (mb > 4096) {
+            cout << "Invalid size! Arrays are limited to 4096 MB." << endl;
+            return;
+        }
+        visualizer.displaySearchLatency(visualizer.searchLatency(static_cast<size_t>(mb) << 20));
+    }
+    
+    // Compares all algorithms, as jobs of the scheduler when the concurrent runner is on
+    void handleCompare() {
+        if (scheduler.workers == 1) {
+            visualizer.compareAlgorithms();
+            return;
+        }
+        const DataArena& input = visualizer.getInput();
+        shared_ptr<const vector<int>> keys(new vector<int>(input.begin(), input.end()));
+        vector<BenchmarkJob> jobs(visualizer.getAlgorithmNames().size());
+        for (size_t i = 0; i < jobs.size(); ++i) {
+            jobs[i].algorithm = i;
+            jobs[i].distributionName = visualizer.getDistributionName();
+            jobs[i].size = keys->size();
+            jobs[i].seed = visualizer.getArraySeed();
+            jobs[i].keys = keys;
+        }
+        size_t workers = JobScheduler(scheduler, cout).run(jobs, visualizer);
+        cout << "Ran " << jobs.size() << " jobs on " << workers << (workers == 1 ? " core" : " cores") << endl;
+        visualizer.compareAlgorithms(&jobs);
+    }
+    
+    void handleConcurrentRunner() {
+        cout << "\n=== CONCURRENT RUNNER ===" << endl;
+        cout << "Jobs run side by side, each pinned to its own physical core with its own copy of the input." << endl;
+        long long workers;
+        cout << "Workers (0 = all cores, 1 = serial, now " << scheduler.workers << "): ";
+        cin >> workers;
+        double timeout;
+        cout << "Job timeout in seconds (0 = none, now " << visualizer.getJobTimeout() << "): ";
+        cin >> timeout;
+        if (workers < 0 || timeout < 0.0) {
+            cout << "Invalid worker count or timeout!" << endl;
+            return;
+        }
+        scheduler.workers = static_cast<size_t>(workers);
+        visualizer.setJobTimeout(timeout);
+        cout << "Compare All Algorithms now runs " << (workers == 1 ? "serially" : "concurrently")
+             << "; jobs predicted to take longer than the timeout are skipped." << endl;
+    }
+    
+    void handleMemoryProfile() {
+        size_t defaultMb = MemoryProbe::defaultMaxBytes() >> 20;
+        cout << "\n=== MEMORY HIERARCHY PROFILE ===" << endl;
+        cout << "Largest working set in MB (0 = " << defaultMb << "): ";
+        
+        long long mb;
+        cin >> mb;
+        if (mb <= 0) mb = defaultMb;
+        if (mb > 4096) {
+            cout << "Invalid size! Working sets are limited to 4096 MB." << endl;
+            return;
+        }
+        
+        int choice;
+        cout << "Huge pages for the probes and benchmark arrays (" << (visualizer.hugePagesEnabled() ? "on" : "off")
+             << "): 1. On  2. Off: ";
+        cin >> choice;
+        if (choice != 1 && choice != 2) {
+            cout << "Invalid choice!" << endl;
+            return;
+        }
+        visualizer.setHugePages(choice == 1);
+        visualizer.displayMemoryProfile(visualizer.profileMemory(static_cast<size_t>(mb) << 20));
+        cout << "The size sweep and search latency tables now mark these levels." << endl;
+    }
+    
+    void handleQueryBatch() {
+        QueryBatchConfig config;
+        cout << "\n=== BATCH QUERIES ===" << endl;
+        cout << "Number of queries (default " << config.queries << "): ";
+        cin >> config.queries;
+        cout << "Hit ratio 0..1 (default " << config.hitRatio << "): ";
+        cin >> config.hitRatio;
+        if (config.queries == 0 || config.hitRatio < 0.0 || config.hitRatio > 1.0) {
+            cout << "Invalid query count or hit ratio!" << endl;
+            return;
+        }
+        cout << "Hits pick sorted positions from a distribution." << endl;
+        if (!readDistribution(config.distribution)) return;
+        
+        visualizer.displayQueryThroughput(config, visualizer.queryThroughput(config));
+    }
+    
+    void handleExternalSort() {
+        ExternalSortConfig config;
+        cout << "\n=== EXTERNAL SORT ===" << endl;
+        cout << "Input file of raw int32 keys: ";
+        cin >> config.input;
+        cout << "Output file: ";
+        cin >> config.output;
+        
+        long long mb;
+        cout << "Memory budget in MB (default " << (config.memoryBytes >> 20) << "): ";
+        cin >> mb;
+        if (mb <= 0 || config.input == config.output) {
+            cout << "Invalid memory budget or output file!" << endl;
+            return;
+        }
+        config.memoryBytes = static_cast<size_t>(mb) << 20;
+        
+        // Runs are sorted with introsort, quicksort or merge sort
+        int choice;
+        cout << "Run sort: 1. Introsort  2. Quick Sort  3. Merge Sort: ";
+        cin >> choice;
+        const size_t sorts[] = {11, 4, 3};
+        if (choice < 1 || choice > 3) {
+            cout << "Invalid choice!" << endl;
+            return;
+        }
+        
+        ExternalSortResult result;
+        if (visualizer.externalSort(config, sorts[choice - 1], result)) {
+            visualizer.displayExternalSort(config, sorts[choice - 1], result);
+        }
+    }
+    
+    // Replays, saves or loads the trace of a visualized run
+    void handleTrace() {
+        cout << "\n=== TRACE REPLAY ===" << endl;
+        cout << "1. Replay last run" << endl;
+        cout << "2. Save last run to a file" << endl;
+        cout << "3. Load a trace file and replay it" << endl;
+        cout << "Choose option: ";
+        int option;
+        cin >> option;
+        if (option < 1 || option > 3) {
+            cout << "Invalid option!" << endl;
+            return;
+        }
+        if (option != 3 && visualizer.getTrace().empty()) {
+            cout << "No trace yet! Run an algorithm with visualization first (options 1-7)." << endl;
+            return;
+        }
+        
+        string path;
+        if (option != 1) {
+            cout << (option == 2 ? "Trace file to write: " : "Trace file to load: ");
+            cin >> path;
+        }
+        if (option == 2) {
+            if (visualizer.saveTrace(path)) {
+                cout << "Saved " << visualizer.getTrace().size() << " events to " << path << endl;
+            } else {
+                cout << "Cannot write trace: " << path << endl;
+            }
+            return;
+        }
+        if (option == 3 && !visualizer.loadTrace(path)) return;
+        
+        ReplayConfig config = visualizer.getReplayConfig();
+        cout << "Pause per frame in ms (default " << config.delayMs << "): ";
+        cin >> config.delayMs;
+        cout << "Frames for arrays above " << config.fullLimit << " elements (default " << config.frames << "): ";
+        cin >> config.frames;
+        if (config.delayMs < 0 || config.frames == 0) {
+            cout << "Invalid pause or frame count!" << endl;
+            return;
+        }
+        visualizer.setReplayConfig(config);
+        visualizer.replayTrace();
+    }
+    
+    // Lists the input distributions and reads one by name
+    bool readDistribution(Distribution& distribution) {
+        cout << "Input distributions:" << endl;
+        for (const DistributionInfo& info : InputGenerator::distributions()) {
+            cout << "  " << setw(14) << left << info.name << info.description << endl;
+        }
+        cout << "Distribution name: ";
+        
+        string name;
+        cin >> name;
+        if (!InputGenerator::parse(name, distribution)) {
+            cout << "Unknown distribution!" << endl;
+            return false;
+        }
+        return true;
+    }
+    
+    void handleArrayInput() {
+        cout << "\n=== ARRAY INPUT OPTIONS ===" << endl;
+        cout << "1. Generate random array" << endl;
+        cout << "2. Enter array manually" << endl;
+        cout << "3. Generate from a distribution" << endl;
+        cout << "4. Load dataset file" << endl;
+        cout << "5. Import text file as dataset" << endl;
+        cout << "6. Save loaded array as dataset" << endl;
+        cout << "Choose option: ";
+        
+        int option;
+        cin >> option;
+        
+        vector<int> array;
+        string distribution = "custom";
+        uint64_t seed = 0;
+        
+        if (option >= 4 && option <= 6) {
+            handleDataset(option);
+            return;
+        }
+        
+        if (option == 1) {
+            int size;
+            cout << "Enter array size: ";
+            cin >> size;
+            array = visualizer.generateRandomArray(size);
+            distribution = "uniform";
+            seed = visualizer.getGeneratorSeed();
+        } else if (option == 3) {
+            Distribution d;
+            if (!readDistribution(d)) return;
+            
+            int size;
+            GeneratorParams params;
+            cout << "Enter array size: ";
+            cin >> size;
+            cout << "Value range min max (default " << params.minVal << " " << params.maxVal << "): ";
+            cin >> params.minVal >> params.maxVal;
+            if (size < 0 || params.maxVal < params.minVal) {
+                cout << "Invalid size or range!" << endl;
+                return;
+            }
+            array = visualizer.generateArray(d, size, params);
+            distribution = InputGenerator::info(d).name;
+            seed = visualizer.getGeneratorSeed();
+        } else if (option == 2) {
+            int size;
+            cout << "Enter array size: ";
+            cin >> size;
+            cout << "Enter " << size << " elements separated by spaces: ";
+            array.resize(size);
+            for (int i = 0; i < size; ++i) {
+                cin >> array[i];
+            }
+        } else {
+            cout << "Invalid option!" << endl;
+            return;
+        }
+        
+        visualizer.setArray(std::move(array), distribution, seed);
+        cout << "Array set successfully: ";
+        visualizer.displayArray(visualizer.getInput().begin(), visualizer.getInput().end());
+    }
+    
+    // Options 4-6 of the array input menu
+    void handleDataset(int option) {
+        string path;
+        if (option == 6) {
+            if (visualizer.getInput().empty()) {
+                cout << "No array data to save!" << endl;
+                return;
+            }
+            cout << "Dataset file to write: ";
+            cin >> path;
+            if (visualizer.saveDataset(path)) {
+                cout << "Saved " << visualizer.getInput().size() << " keys to " << path << endl;
+            } else {
+                cout << "Cannot write dataset: " << path << endl;
+            }
+            return;
+        }
+        
+        if (option == 5) {
+            string textPath, error;
+            cout << "Text file (integers separated by spaces, commas or newlines): ";
+            cin >> textPath;
+            cout << "Dataset file to write: ";
+            cin >> path;
+            if (!DatasetWriter::importText(textPath, path, error)) {
+                cout << error << endl;
+                return;
+            }
+        } else {
+            cout << "Dataset file: ";
+            cin >> path;
+        }
+        
+        if (!visualizer.loadDataset(path)) return;
+        cout << "Loaded " << visualizer.getInput().size() << " keys (" << visualizer.getDistributionName()
+             << ", seed " << visualizer.getArraySeed() << "): ";
+        visualizer.displayArray(visualizer.getInput().begin(), visualizer.getInput().end());
+    }
+};
+
+// Build and host details recorded alongside every machine-readable result set
+struct RunMetadata {
+    string compiler;
+    string buildFlags;
+    string cpu;
+    string date;
+    string generator;
+    unsigned seed = 0;
+    size_t threads = 1;
+    string simd;                    // instruction set of the SIMD sort kernels
+    vector<string> counterNames;    // hardware counters present in each record, if any
+    
+    static RunMetadata collect() {
+        RunMetadata meta;
+#if defined(__clang__)
+        meta.compiler = string("clang ") + __clang_version__;
+#elif defined(__GNUC__)
+        meta.compiler = string("gcc ") + __VERSION__;
+#elif defined(_MSC_VER)
+        meta.compiler = "msvc " + to_string(_MSC_VER);
+#else
+        meta.compiler = "unknown";
+#endif
+
+#ifdef ANALYZER_BUILD_FLAGS
+        meta.buildFlags = ANALYZER_BUILD_FLAGS;
+#else
+        // Without explicit flags, record what the preprocessor can tell us
+        meta.buildFlags = "-std=c++" + to_string(__cplusplus / 100 % 100);
+#ifdef __OPTIMIZE__
+        meta.buildFlags += " optimized";
+#else
+        meta.buildFlags += " -O0";
+#endif
+#ifdef NDEBUG
+        meta.buildFlags += " -DNDEBUG";
+#endif
+#ifdef __AVX2__
+        meta.buildFlags += " avx2";
+#endif
+#endif
+
+        meta.cpu = cpuModelName();
+        
+        time_t now = time(nullptr);
+        char buffer[32];
+        strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+        meta.date = buffer;
+        return meta;
+    }
+};
+
+// One benchmarked algorithm at one input size
+struct BenchmarkRecord {
+    string algorithm;
+    string complexity;
+    string distribution;
+    int size = 0;
+    BenchmarkStats stats;
+    OperationCounts operations;
+    uint64_t peakMemory = 0;    // peak RSS of the counted run in bytes, 0 when unknown
+};
+
+class ResultsWriter {
+public:
+    // Long format: one row per measured run, metadata as leading comment lines
+    static void writeCsv(ostream& out, const RunMetadata& meta, const vector<BenchmarkRecord>& records) {
+        out << "# compiler: " << meta.compiler << "\n";
+        out << "# flags: " << meta.buildFlags << "\n";
+        out << "# cpu: " << meta.cpu << "\n";
+        out << "# date: " << meta.date << "\n";
+        out << "# threads: " << meta.threads << "\n";
+        out << "# simd: " << meta.simd << "\n";
+        out << "algorithm,generator,seed,size,run,seconds\n";
+        
+        out << fixed << setprecision(9);
+        for (const BenchmarkRecord& record : records) {
+            for (size_t run = 0; run < record.stats.samples.size(); ++run) {
+                out << csvField(record.algorithm) << "," << record.distribution << "," << meta.seed << ","
+                    << record.size << "," << run << "," << record.stats.samples[run] << "\n";
+            }
+        }
+    }
+    
+    static void writeJson(ostream& out, const RunMetadata& meta, const vector<BenchmarkRecord>& records) {
+        out << "{\n";
+        out << "  \"metadata\": {\n";
+        out << "    \"compiler\": " << jsonString(meta.compiler) << ",\n";
+        out << "    \"flags\": " << jsonString(meta.buildFlags) << ",\n";
+        out << "    \"cpu\": " << jsonString(meta.cpu) << ",\n";
+        out << "    \"date\": " << jsonString(meta.date) << ",\n";
+        out << "    \"generator\": " << jsonString(meta.generator) << ",\n";
+        out << "    \"threads\": " << meta.threads << ",\n";
+        out << "    \"simd\": " << jsonString(meta.simd) << ",\n";
+        out << "    \"seed\": " << meta.seed << "\n";
+        out << "  },\n";
+        out << "  \"results\": [";
+        
+        out << fixed << setprecision(9);
+        for (size_t r = 0; r < records.size(); ++r) {
+            const BenchmarkRecord& record = records[r];
+            const BenchmarkStats& stats = record.stats;
+            out << (r == 0 ? "\n" : ",\n");
+            out << "    {\n";
+            out << "      \"algorithm\": " << jsonString(record.algorithm) << ",\n";
+            out << "      \"complexity\": " << jsonString(record.complexity) << ",\n";
+            out << "      \"distribution\": " << jsonString(record.distribution) << ",\n";
+            out << "      \"size\": " << record.size << ",\n";
+            out << "      \"warmup_runs\": " << stats.warmupRuns << ",\n";
+            out << "      \"runs\": " << stats.samples.size() << ",\n";
+            out << "      \"min\": " << stats.minTime << ",\n";
+            out << "      \"median\": " << stats.median << ",\n";
+            out << "      \"p95\": " << stats.p95 << ",\n";
+            out << "      \"mean\": " << stats.mean << ",\n";
+            out << "      \"stddev\": " << stats.stddev << ",\n";
+            if (!stats.counters.empty()) {
+                out << "      \"counters\": {";
+                for (size_t e = 0; e < stats.counters.size() && e < meta.counterNames.size(); ++e) {
+                    out << (e == 0 ? "" : ", ") << jsonString(meta.counterNames[e]) << ": ";
+                    if (std::isnan(stats.counters[e])) {
+                        out << "null";
+                    } else {
+                        out << setprecision(0) << stats.counters[e] << setprecision(9);
+                    }
+                }
+                out << "},\n";
+            }
+            out << "      \"operations\": {\"comparisons\": " << record.operations.comparisons
+                << ", \"swaps\": " << record.operations.swaps
+                << ", \"writes\": " << record.operations.writes
+                << ", \"allocations\": " << record.operations.allocations
+                << ", \"allocated_bytes\": " << record.operations.allocatedBytes << "},\n";
+            out << "      \"peak_memory_bytes\": ";
+            if (record.peakMemory) out << record.peakMemory; else out << "null";
+            out << ",\n";
+            out << "      \"samples\": [";
+            for (size_t i = 0; i < stats.samples.size(); ++i) {
+                out << (i == 0 ? "" : ", ") << stats.samples[i];
+            }
+            out << "]\n";
+            out << "    }";
+        }
+        out << (records.empty() ? "]\n" : "\n  ]\n");
+        out << "}\n";
+    }
+    
+private:
+    static string csvField(const string& text) {
+        if (text.find_first_of(",\"") == string::npos) return text;
+        string quoted = "\"";
+        for (char c : text) {
+            if (c == '"') quoted += '"';
+            quoted += c;
+        }
+        return quoted + "\"";
+    }
+    
+    static string jsonString(const string& text) {
+        ostringstream out;
+        out << '"';
+        for (unsigned char c : text) {
+            switch (c) {
+                case '"':  out << "\\\""; break;
+                case '\\': out << "\\\\"; break;
+                case '\n': out << "\\n"; break;
+                case '\t': out << "\\t"; break;
+                default:
+                    if (c < 0x20) {
+                        out << "\\u" << hex << setw(4) << setfill('0') << static_cast<int>(c) << dec << setfill(' ');
+                    } else {
+                        out << c;
+                    }
+            }
+        }
+        out << '"';
+        return out.str();
+    }
+};
+
+// Change between the run times of a baseline and a current measurement. The Mann-Whitney
+// U test decides whether the two differ at all; the Hodges-Lehmann estimate of the shift in
+// log time gives the ratio, and its confidence interval is cut at the test's critical value,
+// so the interval leaves out no change exactly when the test rejects.
+struct ChangeEstimate {
+    double ratio = 1.0;         // current / baseline time
+    double low = 1.0;           // confidence interval of the ratio
+    double high = 1.0;
+    double pValue = 1.0;        // two-sided
+    double minPValue = 1.0;     // smallest p-value these sample sizes can reach
+};
+
+// Null distribution of the Mann-Whitney U statistic for samples of n1 and n2 values: exact
+// up to kExactPairs pairs, beyond that the normal approximation with tie and continuity
+// correction. Ties are rare in run times; the exact distribution ignores them.
+class RankSumTest {
+private:
+    double pairs;
+    double deviation = 0.0;
+    vector<double> lowerTail;       // P(U <= u), empty when approximated
+    
+public:
+    static const size_t kExactPairs = 2500;
+    
+    // tieTerm is the sum of t³ - t over the groups of t tied values in the pooled sample
+    RankSumTest(size_t n1, size_t n2, double tieTerm) : pairs(static_cast<double>(n1) * n2) {
+        double n = static_cast<double>(n1 + n2);
+        if (n > 1) deviation = sqrt(max(0.0, pairs / 12 * ((n + 1) - tieTerm / (n * (n - 1)))));
+        if (n1 * n2 > kExactPairs) return;
+        
+        // ways[j][u] counts the orders of i values of one sample and j of the other with U = u:
+        // the largest value either beats all j values of the other sample or belongs to it
+        if (n1 < n2) swap(n1, n2);
+        size_t maxU = n1 * n2;
+        vector<vector<double>> ways(n2 + 1, vector<double>(maxU + 1, 0.0));
+        for (size_t j = 0; j <= n2; ++j) ways[j][0] = 1.0;
+        for (size_t i = 1; i <= n1; ++i) {
+            vector<vector<double>> next(n2 + 1, vector<double>(maxU + 1, 0.0));
+            next[0][0] = 1.0;
+            for (size_t j = 1; j <= n2; ++j) {
+                for (size_t u = 0; u <= i * j; ++u) {
+                    next[j][u] = next[j - 1][u] + (u >= j ? ways[j][u - j] : 0.0);
+                }
+            }
+            ways.swap(next);
+        }
+        
+        double total = 0.0;
+        for (double w : ways[n2]) total += w;
+        lowerTail.resize(maxU + 1);
+        double sum = 0.0;
+        for (size_t u = 0; u <= maxU; ++u) {
+            sum += ways[n2][u];
+            lowerTail[u] = sum / total;
+        }
+    }
+    
+    // Two-sided p-value when the smaller of U and pairs - U is distance
+    double pValue(size_t distance) const {
+        if (!lowerTail.empty()) return min(1.0, 2 * lowerTail[min(distance, lowerTail.size() - 1)]);
+        if (deviation <= 0.0) return 1.0;
+        double z = (pairs / 2 - distance - 0.5) / deviation;
+        return min(1.0, erfc(max(0.0, z) / sqrt(2.0)));
+    }
+    
+    // Largest U the test rejects at level alpha, -1 when no U is extreme enough
+    long criticalValue(double alpha) const {
+        if (pValue(0) >= alpha) return -1;
+        size_t lo = 0, hi = static_cast<size_t>(pairs / 2);
+        while (lo < hi) {
+            size_t mid = (lo + hi + 1) / 2;
+            if (pValue(mid) < alpha) lo = mid; else hi = mid - 1;
+        }
+        return static_cast<long>(lo);
+    }
+};
+
+const size_t RankSumTest::kExactPairs;
+
+inline ChangeEstimate estimateChange(const vector<double>& baseline, const vector<double>& current, double alpha) {
+    ChangeEstimate estimate;
+    if (baseline.empty() || current.empty()) return estimate;
+    
+    // Log times; long samples are thinned to every k-th order statistic, and the test and
+    // the interval both work on the thinned samples
+    auto thin = [](vector<double> sample) {
+        sort(sample.begin(), sample.end());
+        size_t step = (sample.size() + 999) / 1000;
+        vector<double> kept;
+        for (size_t i = 0; i < sample.size(); i += step) kept.push_back(log(max(sample[i], 1e-12)));
+        return kept;
+    };
+    vector<double> a = thin(baseline), b = thin(current);
+    
+    // Ties of the pooled sample for the variance correction
+    vector<double> pooled(a);
+    pooled.insert(pooled.end(), b.begin(), b.end());
+    sort(pooled.begin(), pooled.end());
+    double tieTerm = 0.0;
+    for (size_t i = 0; i < pooled.size();) {
+        size_t j = i;
+        while (j < pooled.size() && pooled[j] == pooled[i]) ++j;
+        double t = static_cast<double>(j - i);
+        tieTerm += t * t * t - t;
+        i = j;
+    }
+    
+    // Pairwise differences: U counts the positive ones. Zero differences count against a
+    // change in either direction, so ties make the test conservative and the test rejects
+    // exactly when the interval below leaves out zero.
+    vector<double> differences;
+    differences.reserve(a.size() * b.size());
+    for (double y : b) {
+        for (double x : a) differences.push_back(y - x);
+    }
+    sort(differences.begin(), differences.end());
+    size_t m = differences.size();
+    size_t atMost = upper_bound(differences.begin(), differences.end(), 0.0) - differences.begin();
+    size_t atLeast = differences.end() - lower_bound(differences.begin(), differences.end(), 0.0);
+    
+    RankSumTest test(a.size(), b.size(), tieTerm);
+    estimate.pValue = test.pValue(min(atMost, atLeast));
+    estimate.minPValue = test.pValue(0);
+    
+    double middle = m % 2 ? differences[m / 2] : (differences[m / 2 - 1] + differences[m / 2]) / 2;
+    estimate.ratio = exp(middle);
+    
+    // Shifts the test does not reject: all but the critical value's worth of differences at
+    // each end, any shift at all when no outcome is significant
+    long critical = test.criticalValue(alpha);
+    if (critical < 0) {
+        estimate.low = 0.0;
+        estimate.high = numeric_limits<double>::infinity();
+    } else {
+        estimate.low = exp(differences[critical]);
+        estimate.high = exp(differences[m - 1 - critical]);
+    }
+    return estimate;
+}
+
+// Run timings saved as a baseline: the CSV the runner writes, read back
+class BaselineStore {
+public:
+    static bool save(const string& path, const RunMetadata& meta, const vector<BenchmarkRecord>& records) {
+        ofstream out(path.c_str());
+        if (!out) return false;
+        ResultsWriter::writeCsv(out, meta, records);
+        return static_cast<bool>(out);
+    }
+    
+    // Records with their samples; metadata comes from the comment lines and the seed column
+    static bool load(const string& path, RunMetadata& meta, vector<BenchmarkRecord>& records, string& error) {
+        ifstream in(path.c_str());
+        if (!in) {
+            error = "Cannot open baseline: " + path;
+            return false;
+        }
+        records.clear();
+        string line;
+        bool header = false;
+        size_t lineNumber = 0;
+        while (getline(in, line)) {
+            ++lineNumber;
+            if (line.empty()) continue;
+            if (line[0] == '#') {
+                size_t colon = line.find(':');
+                if (colon == string::npos) continue;
+                string key = line.substr(2, colon - 2), value = line.substr(min(line.size(), colon + 2));
+                if (key == "compiler") meta.compiler = value;
+                else if (key == "flags") meta.buildFlags = value;
+                else if (key == "cpu") meta.cpu = value;
+                else if (key == "date") meta.date = value;
+                else if (key == "simd") meta.simd = value;
+                continue;
+            }
+            if (!header) {
+                header = line == "algorithm,generator,seed,size,run,seconds";
+                if (!header) break;
+                continue;
+            }
+            
+            vector<string> fields = splitCsv(line);
+            if (fields.size() != 6) {
+                error = path + ":" + to_string(lineNumber) + ": expected 6 fields";
+                return false;
+            }
+            try {
+                meta.seed = static_cast<unsigned>(stoul(fields[2]));
+                int size = stoi(fields[3]);
+                double seconds = stod(fields[5]);
+                if (records.empty() || records.back().algorithm != fields[0] ||
+                    records.back().distribution != fields[1] || records.back().size != size) {
+                    BenchmarkRecord record;
+                    record.algorithm = fields[0];
+                    record.distribution = fields[1];
+                    record.size = size;
+                    records.push_back(record);
+                }
+                records.back().stats.samples.push_back(seconds);
+            } catch (const exception&) {
+                error = path + ":" + to_string(lineNumber) + ": malformed number";
+                return false;
+            }
+        }
+        if (!header) {
+            error = "Not a results CSV: " + path;
+            return false;
+        }
+        for (BenchmarkRecord& record : records) {
+            record.stats = BenchmarkEngine::summarize(record.stats.samples);
+        }
+        return true;
+    }
+    
+private:
+    static vector<string> splitCsv(const string& line) {
+        vector<string> fields(1);
+        bool quoted = false;
+        for (size_t i = 0; i < line.size(); ++i) {
+            char c = line[i];
+            if (quoted) {
+                if (c == '"' && i + 1 < line.size() && line[i + 1] == '"') {
+                    fields.back() += '"';
+                    ++i;
+                } else if (c == '"') {
+                    quoted = false;
+                } else {
+                    fields.back() += c;
+                }
+            } else if (c == '"') {
+                quoted = true;
+            } else if (c == ',') {
+                fields.push_back(string());
+            } else {
+                fields.back() += c;
+            }
+        }
+        return fields;
+    }
+};
+
+// Thresholds for calling a difference between two runs real
+struct BaselineConfig {
+    double alpha = 0.01;            // significance level, also sets the confidence of the intervals
+    double minChange = 0.05;        // smaller relative changes are reported as unchanged
+};
+
+// Compares every record with its baseline counterpart of the same algorithm, generator and
+// size. A change counts only when it is significant and at least minChange large.
+class BaselineDiff {
+public:
+    // Prints the comparison and returns the number of regressions
+    static size_t report(ostream& out, const RunMetadata& baselineMeta, const vector<BenchmarkRecord>& baseline,
+                         const RunMetadata& currentMeta, const vector<BenchmarkRecord>& current,
+                         const BaselineConfig& config) {
+        out << "\n=== BASELINE COMPARISON ===" << endl;
+        out << "Baseline: " << baselineMeta.date << ", " << baselineMeta.compiler << ", " << baselineMeta.buildFlags << endl;
+        out << "Current:  " << currentMeta.date << ", " << currentMeta.compiler << ", " << currentMeta.buildFlags << endl;
+        if (baselineMeta.cpu != currentMeta.cpu) {
+            out << "Warning: the baseline ran on " << baselineMeta.cpu << ", this run on " << currentMeta.cpu << endl;
+        }
+        if (baselineMeta.seed != currentMeta.seed) {
+            out << "Warning: seeds differ (" << baselineMeta.seed << " vs " << currentMeta.seed
+                << "), so the inputs differ too; pass --seed=" << baselineMeta.seed << " to reuse them" << endl;
+        }
+        
+        ostringstream level;
+        level << fixed << setprecision(0) << (1 - config.alpha) * 100 << "% CI";
+        out << setw(24) << left << "Algorithm" << setw(14) << left << "Generator" << setw(10) << right << "n"
+            << setw(14) << right << "Baseline" << setw(14) << right << "Current" << setw(10) << right << "Change"
+            << setw(20) << right << level.str() << setw(10) << right << "p" << "  Verdict" << endl;
+        
+        size_t regressions = 0, improvements = 0, unchanged = 0, untested = 0;
+        for (const BenchmarkRecord& record : current) {
+            const BenchmarkRecord* before = nullptr;
+            for (const BenchmarkRecord& candidate : baseline) {
+                if (candidate.algorithm == record.algorithm && candidate.distribution == record.distribution &&
+                    candidate.size == record.size) {
+                    before = &candidate;
+                    break;
+                }
+            }
+            out << setw(24) << left << record.algorithm << setw(14) << left << record.distribution
+                << setw(10) << right << record.size;
+            if (!before) {
+                out << setw(14) << right << "-" << setw(14) << right << formatDuration(record.stats.median)
+                    << "  not in the baseline" << endl;
+                continue;
+            }
+            out << setw(14) << right << formatDuration(before->stats.median)
+                << setw(14) << right << formatDuration(record.stats.median);
+            
+            // Below the smallest reachable p-value even complete separation would pass as unchanged
+            ChangeEstimate change = estimateChange(before->stats.samples, record.stats.samples, config.alpha);
+            if (change.minPValue >= config.alpha) {
+                out << "  too few runs to test" << endl;
+                ++untested;
+                continue;
+            }
+            ostringstream percent, interval, p;
+            percent << showpos << fixed << setprecision(1) << (change.ratio - 1) * 100 << "%";
+            interval << showpos << fixed << setprecision(1) << "[" << (change.low - 1) * 100 << ", "
+                     << (change.high - 1) * 100 << "]%";
+            p << setprecision(2) << change.pValue;
+            out << setw(10) << right << percent.str() << setw(20) << right << interval.str()
+                << setw(10) << right << p.str();
+            
+            bool significant = change.pValue < config.alpha;
+            if (significant && change.ratio >= 1 + config.minChange) {
+                out << "  REGRESSION" << endl;
+                ++regressions;
+            } else if (significant && change.ratio <= 1 - config.minChange) {
+                out << "  improvement" << endl;
+                ++improvements;
+            } else {
+                out << "  unchanged" << endl;
+                ++unchanged;
+            }
+        }
+        out << regressions << (regressions == 1 ? " regression, " : " regressions, ") << improvements
+            << (improvements == 1 ? " improvement, " : " improvements, ") << unchanged << " unchanged";
+        if (untested > 0) out << ", " << untested << " with too few runs";
+        out << " (p < " << config.alpha << " and a change of at least " << config.minChange * 100 << "% to count)" << endl;
+        return regressions;
+    }
+};
+
+// Batch entry point: runs the selected benchmarks without any interactive prompts
+class CommandLineRunner {
+private:
+    AlgorithmVisualizer visualizer;
+    vector<size_t> algorithms;
+    vector<int> sizes;
+    vector<Distribution> distributions;
+    GeneratorParams params;
+    string format = "csv";
+    string outputPath;
+    int quadraticLimit = SweepConfig().quadraticLimit;
+    unsigned seed = 0;
+    bool seedGiven = false;
+    bool counters = false;
+    BenchmarkConfig config;
+    ExternalSortConfig externalConfig;
+    string inputPath;
+    string importPath;
+    string savePath;
+    string tracePath;
+    string replayPath;
+    bool calibrate = false;
+    size_t profileBytes = 0;        // --memory-profile: largest working set, 0 = no profile
+    bool hugePages = false;
+    SchedulerConfig scheduler;
+    string baselinePath;
+    string saveBaselinePath;
+    BaselineConfig baselineConfig;
+    double jobTimeout = -1.0;       // --job-timeout, negative = the visualizer's default
+    ReplayConfig replayConfig;
+    
+public:
+    int run(int argc, char* argv[]) {
+        for (int i = 1; i < argc; ++i) {
+            string arg = argv[i];
+            if (arg == "--help" || arg == "-h") {
+                printUsage(argv[0]);
+                return 0;
+            }
+            if (!parseOption(arg)) {
+                cerr << "Invalid option: " << arg << endl;
+                cerr << "Run with --help for usage." << endl;
+                return 1;
+            }
+        }
+        
+        if (params.maxVal < params.minVal) {
+            cerr << "Invalid value range: --min must not exceed --max." << endl;
+            return 1;
+        }
+        visualizer.setHugePages(hugePages);
+        if (!externalConfig.input.empty()) {
+            return runExternalSort();
+        }
+        if (profileBytes) {
+            visualizer.displayMemoryProfile(visualizer.profileMemory(profileBytes));
+            return 0;
+        }
+        if (calibrate) {
+            visualizer.displayHybridCalibration(visualizer.calibrateHybrid());
+            string path = HybridTuner::defaultPath();
+            if (!visualizer.saveHybridThresholds(path)) {
+                cerr << "Cannot write " << path << endl;
+                return 1;
+            }
+            cout << "Saved to " << path << endl;
+            return 0;
+        }
+        if (!replayPath.empty()) {
+            visualizer.setReplayConfig(replayConfig);
+            if (!visualizer.loadTrace(replayPath)) return 1;
+            visualizer.replayTrace();
+            return 0;
+        }
+        if (algorithms.empty()) {
+            for (size_t i = 0; i < visualizer.getAlgorithmNames().size(); ++i) algorithms.push_back(i);
+        }
+        if (sizes.empty()) {
+            sizes.push_back(1000);
+        }
+        if (distributions.empty()) {
+            distributions.push_back(Distribution::Uniform);
+        }
+        if (!seedGiven) {
+            random_device rd;
+            seed = rd();
+        }
+        visualizer.setSeed(seed);
+        int datasetStatus = prepareDataset();
+        if (datasetStatus >= 0) return datasetStatus;
+        if (!tracePath.empty()) return recordTrace();
+        if (jobTimeout >= 0.0) visualizer.setJobTimeout(jobTimeout);
+        visualizer.setBenchmarkConfig(config);
+        if (counters && !visualizer.setHardwareCounters(true)) {
+            cerr << "Hardware counters are not available; continuing without them." << endl;
+        }
+        
+        RunMetadata meta = RunMetadata::collect();
+        for (size_t d = 0; d < distributions.size(); ++d) {
+            meta.generator += (d == 0 ? "" : ",") + InputGenerator::info(distributions[d]).name;
+        }
+        meta.seed = seed;
+        if (!inputPath.empty()) {
+            // A dataset records the generator and seed it was made with
+            meta.generator = visualizer.getDistributionName();
+            meta.seed = static_cast<unsigned>(visualizer.getArraySeed());
+        }
+        meta.threads = visualizer.getThreadCount();
+        meta.simd = visualizer.getSortKernels().name;
+        if (visualizer.hardwareCountersEnabled()) {
+            const PerfCounters& perf = visualizer.getPerfCounters();
+            for (size_t e = 0; e < perf.eventCount(); ++e) meta.counterNames.push_back(perf.eventName(e));
+        }
+        
+        vector<BenchmarkRecord> records;
+        if (!inputPath.empty()) {
+            benchmarkLoaded(records);
+        } else if (scheduler.workers != 1) {
+            benchmarkConcurrently(records);
+        } else {
+            for (Distribution distribution : distributions) {
+                for (int size : sizes) {
+                    vector<int> generated = visualizer.generateArray(distribution, size, params);
+                    visualizer.setArray(std::move(generated), InputGenerator::info(distribution).name, visualizer.getGeneratorSeed());
+                    benchmarkLoaded(records);
+                }
+            }
+        }
+        
+        ofstream file;
+        if (!outputPath.empty()) {
+            file.open(outputPath.c_str());
+            if (!file) {
+                cerr << "Cannot open output file: " << outputPath << endl;
+                return 1;
+            }
+        }
+        ostream& out = outputPath.empty() ? cout : file;
+        
+        if (format == "json") {
+            ResultsWriter::writeJson(out, meta, records);
+        } else {
+            ResultsWriter::writeCsv(out, meta, records);
+        }
+        if (!out) return 1;
+        
+        // Regressions against the baseline exit with 2, apart from errors
+        size_t regressions = 0;
+        if (!baselinePath.empty()) {
+            RunMetadata baselineMeta;
+            vector<BenchmarkRecord> baseline;
+            string error;
+            if (!BaselineStore::load(baselinePath, baselineMeta, baseline, error)) {
+                cerr << error << endl;
+                return 1;
+            }
+            regressions = BaselineDiff::report(cerr, baselineMeta, baseline, meta, records, baselineConfig);
+        }
+        if (!saveBaselinePath.empty()) {
+            if (!BaselineStore::save(saveBaselinePath, meta, records)) {
+                cerr << "Cannot write baseline: " << saveBaselinePath << endl;
+                return 1;
+            }
+            cerr << "Saved baseline to " << saveBaselinePath << endl;
+        }
+        return regressions > 0 ? 2 : 0;
+    }
+    
+private:
+    // Runs every algorithm, size and generator combination as a job of the scheduler. Jobs
+    // ran side by side, so their records carry no peak memory.
+    void benchmarkConcurrently(vector<BenchmarkRecord>& records) {
+        vector<BenchmarkJob> jobs;
+        for (Distribution distribution : distributions) {
+            for (int size : sizes) {
+                string distributionName = InputGenerator::info(distribution).name;
+                for (size_t index : algorithms) {
+                    if (visualizer.exceedsQuadraticLimit(index, size, quadraticLimit, distributionName)) {
+                        cerr << "Skipping " << visualizer.getAlgorithmNames()[index] << " at n = " << size << " on "
+                             << distributionName << " input (above --quadratic-limit=" << quadraticLimit << ")" << endl;
+                        continue;
+                    }
+                    BenchmarkJob job;
+                    job.algorithm = index;
+                    job.distribution = distribution;
+                    job.distributionName = distributionName;
+                    job.size = size;
+                    job.seed = seed;
+                    job.params = params;
+                    jobs.push_back(job);
+                }
+            }
+        }
+        
+        size_t workers = JobScheduler(scheduler, cerr).run(jobs, visualizer);
+        cerr << "Ran " << jobs.size() << " jobs on " << workers << (workers == 1 ? " core" : " cores") << endl;
+        
+        for (const BenchmarkJob& job : jobs) {
+            if (job.skipped) continue;
+            BenchmarkRecord record;
+            record.algorithm = visualizer.getAlgorithmNames()[job.algorithm];
+            record.complexity = visualizer.getAlgorithmComplexities()[job.algorithm];
+            record.distribution = job.distributionName;
+            record.size = static_cast<int>(job.size);
+            record.stats = job.stats;
+            record.operations = job.operations;
+            records.push_back(record);
+        }
+    }
+    
+    // Benchmarks every selected algorithm on the loaded array
+    void benchmarkLoaded(vector<BenchmarkRecord>& records) {
+        const string& distributionName = visualizer.getDistributionName();
+        int size = static_cast<int>(visualizer.getInput().size());
+        
+        for (size_t index : algorithms) {
+            const string& name = visualizer.getAlgorithmNames()[index];
+            if (visualizer.exceedsQuadraticLimit(index, size, quadraticLimit, distributionName)) {
+                cerr << "Skipping " << name << " at n = " << size << " on " << distributionName
+                     << " input (above --quadratic-limit=" << quadraticLimit << ")" << endl;
+                continue;
+            }
+            double predicted = 0.0;
+            if (visualizer.predictedOverrun(index, &predicted)) {
+                cerr << "Skipping " << name << " at n = " << size << " on " << distributionName << " input: predicted "
+                     << formatDuration(predicted) << ", over the " << formatDuration(visualizer.getJobTimeout())
+                     << " job timeout" << endl;
+                continue;
+            }
+            
+            BenchmarkRecord record;
+            record.algorithm = name;
+            record.complexity = visualizer.getAlgorithmComplexities()[index];
+            record.distribution = distributionName;
+            record.size = size;
+            record.stats = visualizer.benchmarkAlgorithm(index);
+            if (record.stats.timedOut) {
+                cerr << name << " at n = " << size << " stopped after " << record.stats.samples.size()
+                     << (record.stats.samples.size() == 1 ? " run" : " runs") << " by the job timeout" << endl;
+            }
+            record.operations = visualizer.countAlgorithm(index);
+            record.peakMemory = visualizer.getAlgorithmPeakMemory()[index];
+            records.push_back(record);
+        }
+    }
+    
+    // Handles --import-text, --input and --save-dataset; returns an exit code, or -1 to go on benchmarking
+    int prepareDataset() {
+        if (!importPath.empty()) {
+            if (savePath.empty()) savePath = importPath + ".dat";
+            string error;
+            if (!DatasetWriter::importText(importPath, savePath, error)) {
+                cerr << error << endl;
+                return 1;
+            }
+            cerr << "Imported " << importPath << " into " << savePath << endl;
+            if (inputPath.empty()) return 0;
+        }
+        if (!inputPath.empty()) {
+            // Loading prints its own errors on stdout; keep them off a CSV/JSON stream
+            streambuf* saved = cout.rdbuf(cerr.rdbuf());
+            bool loaded = visualizer.loadDataset(inputPath);
+            cout.rdbuf(saved);
+            return loaded ? -1 : 1;
+        }
+        if (!savePath.empty()) {
+            if (sizes.size() != 1 || distributions.size() != 1) {
+                cerr << "--save-dataset needs exactly one size and one generator." << endl;
+                return 1;
+            }
+            Distribution distribution = distributions.front();
+            vector<int> generated = visualizer.generateArray(distribution, sizes.front(), params);
+            visualizer.setArray(std::move(generated), InputGenerator::info(distribution).name, visualizer.getGeneratorSeed());
+            if (!visualizer.saveDataset(savePath)) {
+                cerr << "Cannot write dataset: " << savePath << endl;
+                return 1;
+            }
+            cerr << "Saved " << sizes.front() << " keys to " << savePath << endl;
+            return 0;
+        }
+        return -1;
+    }
+    
+    // Records the first selected algorithm on the first size and generator, or on the --input keys
+    int recordTrace() {
+        if (inputPath.empty()) {
+            Distribution distribution = distributions.front();
+            vector<int> generated = visualizer.generateArray(distribution, sizes.front(), params);
+            visualizer.setArray(std::move(generated), InputGenerator::info(distribution).name, visualizer.getGeneratorSeed());
+        }
+        visualizer.recordTrace(algorithms.front());
+        if (!visualizer.saveTrace(tracePath)) {
+            cerr << "Cannot write trace: " << tracePath << endl;
+            return 1;
+        }
+        const TraceRecorder& trace = visualizer.getTrace();
+        cerr << "Recorded " << trace.size() << " events of " << trace.algorithmName() << " on "
+             << trace.firstFrame().size() << " keys to " << tracePath;
+        if (trace.folded() > 0) cerr << " (" << trace.folded() << " earlier events folded into the first frame)";
+        cerr << endl;
+        return 0;
+    }
+    
+    // Sorts the --external-sort file with the first selected sort, introsort by default
+    int runExternalSort() {
+        if (externalConfig.output.empty()) externalConfig.output = externalConfig.input + ".sorted";
+        if (externalConfig.output == externalConfig.input) {
+            cerr << "The external sort output must differ from its input." << endl;
+            return 1;
+        }
+        
+        size_t sortIndex = 11;
+        for (size_t index : algorithms) {
+            if (index >= 2) {
+                sortIndex = index;
+                break;
+            }
+        }
+        
+        ExternalSortResult result;
+        if (!visualizer.externalSort(externalConfig, sortIndex, result)) return 1;
+        visualizer.displayExternalSort(externalConfig, sortIndex, result);
+        return 0;
+    }
+    
+    bool parseOption(const string& arg) {
+        if (arg == "--counters") {
+            counters = true;
+            return true;
+        }
+        if (arg == "--calibrate") {
+            calibrate = true;
+            return true;
+        }
+        if (arg == "--memory-profile") {
+            profileBytes = MemoryProbe::defaultMaxBytes();
+            return true;
+        }
+        if (arg == "--huge-pages") {
+            hugePages = true;
+            return true;
+        }
+        
+        size_t eq = arg.find('=');
+        if (arg.compare(0, 2, "--") != 0 || eq == string::npos) return false;
+        string name = arg.substr(2, eq - 2);
+        string value = arg.substr(eq + 1);
+        
+        try {
+            if (name == "algorithms") return parseAlgorithms(value);
+            if (name == "sizes") return parseSizes(value);
+            if (name == "generator") return parseDistributions(value);
+            if (name == "baseline") { baselinePath = value; return !value.empty(); }
+            if (name == "save-baseline") { saveBaselinePath = value; return !value.empty(); }
+            if (name == "alpha") {
+                baselineConfig.alpha = stod(value);
+                return baselineConfig.alpha > 0.0 && baselineConfig.alpha < 0.5;
+            }
+            if (name == "min-change") {
+                baselineConfig.minChange = stod(value) / 100.0;
+                return baselineConfig.minChange >= 0.0;
+            }
+            if (name == "jobs") {
+                int jobs = stoi(value);
+                scheduler.workers = static_cast<size_t>(max(0, jobs));
+                return jobs >= 0;
+            }
+            if (name == "job-timeout") { jobTimeout = stod(value); return jobTimeout >= 0.0; }
+            if (name == "memory-profile") {
+                long long mb = stoll(value);
+                profileBytes = static_cast<size_t>(mb) << 20;
+                return mb > 0 && mb <= 4096;
+            }
+            if (name == "min") { params.minVal = stoi(value); return true; }
+            if (name == "max") { params.maxVal = stoi(value); return true; }
+            if (name == "swaps") { params.swaps = stoul(value); return true; }
+            if (name == "teeth") { params.teeth = stoul(value); return params.teeth > 0; }
+            if (name == "unique") { params.uniqueValues = stoul(value); return params.uniqueValues > 0; }
+            if (name == "zipf") { params.zipfExponent = stod(value); return params.zipfExponent > 0.0; }
+            if (name == "seed") { seed = static_cast<unsigned>(stoul(value)); seedGiven = true; return true; }
+            if (name == "warmup") { config.warmupRuns = stoi(value); return config.warmupRuns >= 0; }
+            if (name == "repetitions") {
+                // A fixed repetition count disables the adaptive stopping rules
+                config.minRuns = config.maxRuns = stoi(value);
+                config.timeBudget = numeric_limits<double>::infinity();
+                config.targetRelativeError = 0.0;
+                return config.minRuns > 0;
+            }
+            if (name == "time-budget") { config.timeBudget = stod(value); return config.timeBudget > 0.0; }
+            if (name == "quadratic-limit") { quadraticLimit = stoi(value); return true; }
+            if (name == "threads") { visualizer.setThreadCount(stoi(value)); return stoi(value) > 0; }
+            if (name == "simd") {
+                simd::Level level;
+                if (!simd::parseLevel(value, level)) return false;
+                visualizer.setSimdLevel(level);
+                return true;
+            }
+            if (name == "parallel-cutoff") { visualizer.setParallelCutoff(stoi(value)); return stoi(value) > 0; }
+            if (name == "input") { inputPath = value; return !value.empty(); }
+            if (name == "import-text") { importPath = value; return !value.empty(); }
+            if (name == "save-dataset") { savePath = value; return !value.empty(); }
+            if (name == "trace") { tracePath = value; return !value.empty(); }
+            if (name == "replay") { replayPath = value; return !value.empty(); }
+            if (name == "replay-delay") { replayConfig.delayMs = stoi(value); return replayConfig.delayMs >= 0; }
+            if (name == "replay-frames") { replayConfig.frames = stoul(value); return replayConfig.frames > 0; }
+            if (name == "external-sort") { externalConfig.input = value; return !value.empty(); }
+            if (name == "external-output") { externalConfig.output = value; return !value.empty(); }
+            if (name == "memory") { externalConfig.memoryBytes = stoull(value) << 20; return stoull(value) > 0; }
+            if (name == "format") { format = value; return value == "csv" || value == "json"; }
+            if (name == "output") { outputPath = value; return !value.empty(); }
+        } catch (const exception&) {
+            return false;
+        }
+        return false;
+    }
+    
+    bool parseAlgorithms(const string& list) {
+        const vector<string>& keys = visualizer.getAlgorithmKeys();
+        for (const string& item : split(list, ',')) {
+            if (item == "all") {
+                for (size_t i = 0; i < keys.size(); ++i) algorithms.push_back(i);
+                continue;
+            }
+            auto it = find(keys.begin(), keys.end(), item);
+            if (it == keys.end()) return false;
+            algorithms.push_back(distance(keys.begin(), it));
+        }
+        return true;
+    }
+    
+    bool parseDistributions(const string& list) {
+        for (const string& item : split(list, ',')) {
+            if (item == "all") {
+                for (const DistributionInfo& info : InputGenerator::distributions()) distributions.push_back(info.id);
+                continue;
+            }
+            Distribution distribution;
+            if (!InputGenerator::parse(item, distribution)) return false;
+            distributions.push_back(distribution);
+        }
+        return !distributions.empty();
+    }
+    
+    // Accepts plain sizes, powers "2^k" and geometric ranges "2^a..2^b"
+    bool parseSizes(const string& list) {
+        for (const string& item : split(list, ',')) {
+            size_t dots = item.find("..");
+            if (dots != string::npos) {
+                int from = parsePower(item.substr(0, dots));
+                int to = parsePower(item.substr(dots + 2));
+                if (from < 0 || to < from) return false;
+                for (int e = from; e <= to; ++e) sizes.push_back(1 << e);
+            } else if (item.compare(0, 2, "2^") == 0) {
+                int e = parsePower(item);
+                if (e < 0) return false;
+                sizes.push_back(1 << e);
+            } else {
+                int size = stoi(item);
+                if (size <= 0) return false;
+                sizes.push_back(size);
+            }
+        }
+        return true;
+    }
+    
+    static int parsePower(const string& text) {
+        if (text.compare(0, 2, "2^") != 0) return -1;
+        int e = stoi(text.substr(2));
+        return (e >= 0 && e <= 30) ? e : -1;
+    }
+    
+    static vector<string> split(const string& text, char separator) {
+        vector<string> parts;
+        string part;
+        istringstream in(text);
+        while (getline(in, part, separator)) {
+            if (!part.empty()) parts.push_back(part);
+        }
+        return parts;
+    }
+    
+    void printUsage(const char* program) const {
+        cout << "Usage: " << program << " [options]" << endl;
+        cout << "Without options the interactive menu is started." << endl;
+        cout << endl;
+        cout << "  --algorithms=LIST      comma-separated: ";
+        const vector<string>& keys = visualizer.getAlgorithmKeys();
+        for (size_t i = 0; i < keys.size(); ++i) cout << keys[i] << (i + 1 < keys.size() ? "," : "");
+        cout << " (default: all)" << endl;
+        cout << "  --sizes=LIST           e.g. 1000,5000 or 2^4..2^16 (default: 1000)" << endl;
+        cout << "  --generator=LIST       comma-separated input distributions or all (default: uniform)" << endl;
+        for (const DistributionInfo& info : InputGenerator::distributions()) {
+            cout << "      " << setw(17) << left << info.name << info.description << endl;
+        }
+        cout << right;
+        cout << "  --min=N, --max=N       value range of generated elements (default: 1..100)" << endl;
+        cout << "  --swaps=N              random swaps for nearly-sorted (default: n/100)" << endl;
+        cout << "  --teeth=N              runs for sawtooth (default: 16)" << endl;
+        cout << "  --unique=N             distinct values for few-unique (default: 8)" << endl;
+        cout << "  --zipf=S               exponent for zipf (default: 1.0)" << endl;
+        cout << "  --seed=N               generator seed (default: random, recorded in output)" << endl;
+        cout << "  --warmup=N             warm-up runs per algorithm" << endl;
+        cout << "  --repetitions=N        fixed number of measured runs" << endl;
+        cout << "  --time-budget=SEC      adaptive mode: stop after SEC seconds per algorithm" << endl;
+        cout << "  --quadratic-limit=N    skip O(n²) algorithms (and quicksort on adversarial input)\n"
+             << "                         above N elements, 0 = never (default: "
+             << SweepConfig().quadraticLimit << ")" << endl;
+        cout << "  --jobs=N               run algorithm x size x generator jobs side by side, one per\n"
+             << "                         physical core with its own input copy; 0 = all cores (default: 1,\n"
+             << "                         serial). Falls back towards serial when a probe shows interference" << endl;
+        cout << "  --job-timeout=SEC      skip jobs a pilot run predicts to take longer, and stop the\n"
+             << "                         runs of those that still overrun; 0 = none (default: "
+             << visualizer.getJobTimeout() << ")" << endl;
+        cout << "  --threads=N            threads for the parallel sorts (default: all cores)" << endl;
+        cout << "  --parallel-cutoff=N    sort ranges up to N elements sequentially (default: 4096)" << endl;
+        cout << "  --simd=LEVEL           kernels for the SIMD sorts: auto (default), avx512, avx2, scalar" << endl;
+        cout << "  --counters             collect hardware performance counters (Linux perf_event_open)" << endl;
+        cout << "  --calibrate            time sorting networks, insertion, intro- and radix sort on this\n"
+             << "                         machine, save the hybrid sort thresholds to "
+             << HybridTuner::defaultPath() << "\n"
+             << "                         (read at every start) and exit" << endl;
+        cout << "  --memory-profile[=MB]  measure load latency and read bandwidth for working sets up to MB\n"
+             << "                         (default: " << (MemoryProbe::defaultMaxBytes() >> 20)
+             << ", four times the LLC), print the cache levels found and exit\n"
+             << "  --huge-pages           back benchmark arrays with transparent huge pages; with\n"
+             << "                         --memory-profile, add a huge page latency column" << endl;
+        cout << "  --input=FILE           benchmark the keys of a dataset file instead of generated input" << endl;
+        cout << "  --save-dataset=FILE    write the generated input (one size, one generator) as a dataset\n"
+             << "                         file and exit; with --import-text, the converted file" << endl;
+        cout << "  --import-text=FILE     convert integers from a text file to a dataset (default name\n"
+             << "                         FILE.dat); combine with --input to benchmark the result" << endl;
+        cout << "  --external-sort=FILE   sort a file of raw int32 keys out of core with the first sort\n"
+             << "                         in --algorithms (default: introsort), then print a report" << endl;
+        cout << "  --external-output=FILE sorted output (default: FILE.sorted); runs go next to it" << endl;
+        cout << "  --memory=MB            memory budget of the external sort (default: 256)" << endl;
+        cout << "  --trace=FILE           record every step of the first algorithm in --algorithms on the\n"
+             << "                         first size and generator (or --input) to a trace file and exit" << endl;
+        cout << "  --replay=FILE          replay a trace file and exit" << endl;
+        cout << "  --replay-delay=MS      pause per replayed frame (default: " << ReplayConfig().delayMs << ")" << endl;
+        cout << "  --replay-frames=N      frames sampled from traces of more than " << ReplayConfig().fullLimit
+             << " elements (default: " << ReplayConfig().frames << ")" << endl;
+        cout << "  --save-baseline=FILE   also save the timings of this run as a baseline (results CSV)" << endl;
+        cout << "  --baseline=FILE        compare this run with a saved baseline (or any results CSV) per\n"
+             << "                         algorithm, generator and size, report on stderr and exit with 2\n"
+             << "                         when anything regressed" << endl;
+        cout << "  --alpha=P              significance level of the baseline comparison; the confidence\n"
+             << "                         intervals are at 1 - P (default: 0.01)" << endl;
+        cout << "  --min-change=PCT       significant changes below PCT% count as unchanged (default: 5)" << endl;
+        cout << "  --format=csv|json      output format (default: csv)" << endl;
+        cout << "  --output=FILE          write results to FILE instead of stdout" << endl;
+    }
+};
+
+int main(int argc, char* argv[]) {
+    if (argc > 1) {
+        CommandLineRunner runner;
+        return runner.run(argc, argv);
+    }
+    
+    MenuSystem menu;
+    menu.run();
+    return 0;
 }
\ No newline at end of file